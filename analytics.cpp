@@ -0,0 +1,181 @@
+#include <cstdint>
+#include <iostream>
+#include "analytics.h"
+#include "parallel.h"
+
+
+bool analyzeProfile(string nameFile, double ce, double ci, profileSummary &ps, string &error) {
+	vector<strategy> s;
+	if (not Model::readStrategyProfile(nameFile, s, error))
+		return false;
+
+	Model model(s);
+	Graph g = model.getGraph();
+
+	ps.nameFile = nameFile;
+	ps.n = s.size();
+	ps.m = 0;
+
+	int immunized = 0;
+	vector<vector<int> > adj(ps.n);
+	for (int i = 0; i < ps.n; ++i) {
+		adj[i] = g.getEdges(i);
+
+		ps.degrees[adj[i].size()]++;
+		ps.ownership[s[i].bought.size()]++;
+		ps.m += s[i].bought.size();
+		immunized += s[i].immunization;
+	}
+	ps.immunizedFraction = (ps.n > 0) ? (double) immunized / ps.n : 0;
+
+	list<VulnerableRegion> vr = model.getVulnerableRegions();
+	list<VulnerableRegion>::iterator it;
+	int maxSize = 0;
+	for (it = vr.begin(); it != vr.end(); ++it) {
+		ps.regionSizes[it->size()]++;
+		maxSize = max(maxSize, (int) it->size());
+	}
+	ps.targetedRegions = (maxSize > 0) ? ps.regionSizes[maxSize] : 0;
+
+	vector<bool> visited(ps.n, false);
+	for (int i = 0; i < ps.n; ++i) {
+		if (not visited[i]) {
+			//Breadth-first search of i's connected component
+			int size = 0;
+			list<int> queue(1, i);
+			visited[i] = true;
+			while (not queue.empty()) {
+				int u = queue.front();
+				queue.pop_front();
+				++size;
+				for (int k = 0; k < adj[u].size(); ++k) {
+					if (not visited[adj[u][k]]) {
+						visited[adj[u][k]] = true;
+						queue.push_back(adj[u][k]);
+					}
+				}
+			}
+			ps.componentSizes[size]++;
+		}
+	}
+
+	getDistances(adj, ps.diameter, ps.averageDistance);
+
+	ps.welfare1attack = model.calculateSocialWelfare(ce, ci, false);
+	ps.welfare2attacks = model.calculateSocialWelfare(ce, ci, true);
+
+	return true;
+}
+
+void getDistances(vector<vector<int> > &adj, int &diameter, double &averageDistance) {
+	int n = adj.size();
+	long long sum = 0; //The sum of the distances between connected nodes
+	long long pairs = 0; //The number of ordered pairs of different connected nodes
+
+	diameter = 0;
+
+	vector<uint64_t> seen(n), frontier(n), next(n);
+	for (int b = 0; b < n; b += 64) {
+		//The sources are the nodes from b to b+63, the source b+t being the bit t
+		int k = min(64, n - b);
+
+		fill(seen.begin(), seen.end(), 0);
+		fill(frontier.begin(), frontier.end(), 0);
+		for (int t = 0; t < k; ++t)
+			seen[b + t] = frontier[b + t] = (uint64_t) 1 << t;
+
+		bool reached = true;
+		for (int d = 1; reached; ++d) {
+			reached = false;
+
+			for (int v = 0; v < n; ++v) {
+				uint64_t r = 0; //The sources whose search reaches v at distance d
+				for (int j = 0; j < adj[v].size(); ++j)
+					r |= frontier[adj[v][j]];
+				next[v] = r & ~seen[v];
+			}
+
+			for (int v = 0; v < n; ++v) {
+				if (next[v]) {
+					reached = true;
+					seen[v] |= next[v];
+
+					int c = __builtin_popcountll(next[v]);
+					sum += (long long) c * d;
+					pairs += c;
+					diameter = max(diameter, d);
+				}
+			}
+
+			frontier.swap(next);
+		}
+	}
+
+	averageDistance = (pairs > 0) ? (double) sum / pairs : 0;
+}
+
+/**
+	Writes a histogram as value:count pairs separated by semicolons.
+
+	@param os The output stream.
+	@param h The histogram.
+*/
+static void printHistogram(ostream &os, Histogram &h) {
+	Histogram::iterator it;
+	for (it = h.begin(); it != h.end(); ++it) {
+		if (it != h.begin())
+			os << ";";
+		os << it->first << ":" << it->second;
+	}
+}
+
+int analyzeProfiles(list<string> files, double ce, double ci, int nThreads, string nameFileSummary) {
+	vector<string> names(files.begin(), files.end());
+	vector<profileSummary> all(names.size());
+	vector<char> wellFormed(names.size()); //Not vector<bool>, which the threads cannot write at the same time
+	vector<string> errors(names.size());
+
+	parallelFor(names.size(), nThreads, [&](int k) {
+		wellFormed[k] = analyzeProfile(names[k], ce, ci, all[k], errors[k]);
+	});
+
+	vector<profileSummary> ps; //The statistics of the files that can be read and are well formed
+	int unreadable = 0;
+	for (int k = 0; k < names.size(); ++k) {
+		if (wellFormed[k])
+			ps.push_back(all[k]);
+		else {
+			cerr << names[k] << ": " << errors[k] << endl;
+			++unreadable;
+		}
+	}
+
+	ofstream myfile;
+	myfile.open(nameFileSummary);
+
+	myfile << "file,n,m,immunized_fraction,targeted_regions,components,largest_component,diameter,average_distance,"
+	       << "welfare_1attack,welfare_2attacks,degrees,ownership,region_sizes,component_sizes" << endl;
+
+	for (int k = 0; k < ps.size(); ++k) {
+		int components = 0;
+		Histogram::iterator it;
+		for (it = ps[k].componentSizes.begin(); it != ps[k].componentSizes.end(); ++it)
+			components += it->second;
+		int largest = ps[k].componentSizes.empty() ? 0 : ps[k].componentSizes.rbegin()->first;
+
+		myfile << ps[k].nameFile << "," << ps[k].n << "," << ps[k].m << "," << ps[k].immunizedFraction << ","
+		       << ps[k].targetedRegions << "," << components << "," << largest << "," << ps[k].diameter << ","
+		       << ps[k].averageDistance << "," << ps[k].welfare1attack << "," << ps[k].welfare2attacks << ",";
+		printHistogram(myfile, ps[k].degrees);
+		myfile << ",";
+		printHistogram(myfile, ps[k].ownership);
+		myfile << ",";
+		printHistogram(myfile, ps[k].regionSizes);
+		myfile << ",";
+		printHistogram(myfile, ps[k].componentSizes);
+		myfile << endl;
+	}
+
+	myfile.close();
+	return unreadable;
+}
@@ -0,0 +1,71 @@
+/**
+	Computes the statistics of the final strategy profiles of the dynamics.
+*/
+
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include <map>
+#include "model.h"
+using namespace std;
+
+///For each value, the number of times it appears:
+typedef map<int, int> Histogram;
+
+struct profileSummary {
+	string nameFile;
+	int n; //The number of players
+	int m; //The number of edges
+	Histogram degrees; //The degrees of the nodes
+	Histogram ownership; //The number of edges bought by each player
+	double immunizedFraction;
+	Histogram regionSizes; //The sizes of the vulnerable regions
+	int targetedRegions; //The number of vulnerable regions of maximum size
+	Histogram componentSizes; //The sizes of the connected components
+	int diameter; //The largest distance between two connected nodes
+	double averageDistance; //The average distance between two different connected nodes
+	double welfare1attack; //The social welfare with the adversary that makes a single attack
+	double welfare2attacks; //The social welfare with the adversary that makes two attacks
+};
+
+
+/**
+	Computes the statistics of the strategy profile stored in a file.
+
+	@param nameFile The name of the file, with the format of Model::exportGraph.
+	@param ce The cost of the edges.
+	@param ci The immunization cost.
+	@param ps The statistics of the strategy profile.
+	@param error If the file cannot be read or is malformed, the description of the error.
+	@returns True if the file can be read and is well formed.
+*/
+bool analyzeProfile(string nameFile, double ce, double ci, profileSummary &ps, string &error);
+
+
+/**
+	Computes the statistics of the strategy profiles stored in some files, in parallel, and exports them as a
+	csv file with a row per profile. The histograms are written as value:count pairs separated by semicolons.
+	The files that cannot be read or are malformed are reported and have no row.
+
+	@param files The names of the files, with the format of Model::exportGraph.
+	@param ce The cost of the edges.
+	@param ci The immunization cost.
+	@param nThreads The number of threads.
+	@param nameFileSummary The name of the csv file.
+	@returns The number of files that cannot be read or are malformed.
+*/
+int analyzeProfiles(list<string> files, double ce, double ci, int nThreads, string nameFileSummary);
+
+
+/**
+	Calculates the diameter and the average distance of a graph, with breadth-first searches from 64 sources
+	at once, which share each pass over the adjacency lists using a bit per source.
+
+	@param[in] adj For each node, the list of its neighbours.
+	@param[out] diameter The largest distance between two connected nodes.
+	@param[out] averageDistance The average distance between two different connected nodes, or 0 if there are
+	                            none.
+*/
+void getDistances(vector<vector<int> > &adj, int &diameter, double &averageDistance);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,473 @@
+/**
+	Differential tests of the optimized implementation (Model, Graph) against the frozen reference one
+	(reference/). Each test generates small random instances from consecutive seeds, compares the results of
+	both implementations, and shrinks the failing instances to minimal ones.
+
+	Usage: difftest [instances] [first seed]
+*/
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "model.h"
+#include "reference/model.h"
+using namespace std;
+
+///A strategy profile with the costs and the adversary:
+struct instance {
+	vector<strategy> s;
+	double ce, ci;
+	bool adv2attacks;
+};
+
+///A test returns an empty string if the instance passes it, or the description of the failure otherwise:
+typedef string (*Test)(instance &in);
+
+
+/**
+	Returns a random instance with at most maxN players.
+
+	@param seed The seed of the instance.
+	@param maxN The maximum number of players, at least 2.
+	@returns The instance.
+*/
+instance randomInstance(unsigned int seed, int maxN) {
+	mt19937 gen(seed);
+
+	instance in;
+	int n = 2 + gen() % (maxN - 1);
+	in.s = vector<strategy>(n);
+	in.ce = (gen() % 30) / 10.0;
+	in.ci = (gen() % 30) / 10.0;
+	in.adv2attacks = gen() % 2;
+
+	double p = (gen() % 100) / 100.0; //The probability that a player immunizes
+	for (int i = 0; i < n; ++i)
+		in.s[i].immunization = (gen() % 100 < p*100);
+
+	//Each pair of players is connected with probability q, and the edge is bought by one of them at random
+	double q = (gen() % 100) / 200.0;
+	for (int i = 0; i < n; ++i) {
+		for (int j = i + 1; j < n; ++j) {
+			if (gen() % 100 < q*100) {
+				if (gen() % 2 == 0)
+					in.s[i].bought.push_back(j);
+				else
+					in.s[j].bought.push_back(i);
+			}
+		}
+	}
+	return in;
+}
+
+/**
+	Returns the reference model of an instance.
+
+	@param in The instance.
+	@returns The reference model with the strategy profile of the instance.
+*/
+reference::Model referenceModel(instance &in) {
+	vector<reference::strategy> s(in.s.size());
+	for (int i = 0; i < in.s.size(); ++i) {
+		s[i].bought = in.s[i].bought;
+		s[i].immunization = in.s[i].immunization;
+	}
+	return reference::Model(s);
+}
+
+/**
+	Says whether two strategies are the same.
+
+	@param b1, y1 The edges bought and the immunization status of the first strategy.
+	@param b2, y2 The edges bought and the immunization status of the second strategy.
+	@returns True if both strategies buy the same edges, in the same order, with the same immunization status.
+*/
+bool sameStrategy(list<int> b1, bool y1, list<int> b2, bool y2) {
+	return b1 == b2 and y1 == y2;
+}
+
+/**
+	Writes an instance to the output stream.
+
+	@param os The output stream.
+	@param in The instance.
+*/
+void printInstance(ostream &os, instance &in) {
+	os << "n = " << in.s.size() << ", ce = " << in.ce << ", ci = " << in.ci << ", adversary = "
+	   << (in.adv2attacks ? 2 : 1) << " attacks" << endl;
+
+	for (int i = 0; i < in.s.size(); ++i) {
+		os << "\t" << i << ": " << (in.s[i].immunization ? "immunized" : "vulnerable") << ", buys {";
+		list<int>::iterator it;
+		for (it = in.s[i].bought.begin(); it != in.s[i].bought.end(); ++it)
+			os << (it == in.s[i].bought.begin() ? "" : ",") << *it;
+		os << "}" << endl;
+	}
+}
+
+
+/**
+	Compares the batched utilities of all the players with the reference utilities.
+*/
+string testUtilities(instance &in) {
+	Model model(in.s);
+	reference::Model ref = referenceModel(in);
+
+	vector<double> u = model.calculateUtilities(in.ce, in.ci, in.adv2attacks);
+
+	for (int i = 0; i < in.s.size(); ++i) {
+		double ru = ref.getUtility(i, in.ce, in.ci, in.adv2attacks);
+		if (u[i] != ru) {
+			stringstream ss;
+			ss << "utility of player " << i << ": " << u[i] << ", reference " << ru;
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Compares the swapstable best responses of all the players with the reference ones.
+*/
+string testSwapstableBR(instance &in) {
+	Model model(in.s);
+	reference::Model ref = referenceModel(in);
+
+	for (int i = 0; i < in.s.size(); ++i) {
+		strategy br = model.bestResponse(i, in.ce, in.ci, in.adv2attacks, SWAPSTABLE);
+		reference::strategy rbr = ref.getSwapstableBR(i, in.ce, in.ci, in.adv2attacks);
+
+		if (not sameStrategy(br.bought, br.immunization, rbr.bought, rbr.immunization)) {
+			stringstream ss;
+			ss << "swapstable best response of player " << i << " differs from the reference";
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Compares the utility of the full best responses of all the players with the best utility among all their
+	strategies, calculated by the reference. The full best responses are never worse than the swapstable ones.
+*/
+string testFullBR(instance &in) {
+	int n = in.s.size();
+	if (n > 7)
+		return ""; //Too many strategies to try them all
+
+	Model model(in.s);
+	reference::Model ref = referenceModel(in);
+
+	for (int i = 0; i < n; ++i) {
+		strategy br = model.bestResponse(i, in.ce, in.ci, in.adv2attacks, FULL);
+		reference::strategy rbr;
+		rbr.bought = br.bought;
+		rbr.immunization = br.immunization;
+		double u = ref.getUtility(i, rbr, in.ce, in.ci, in.adv2attacks);
+
+		double best = ref.getUtility(i, in.ce, in.ci, in.adv2attacks);
+		for (int mask = 0; mask < (1 << n); ++mask) {
+			if (mask & (1 << i))
+				continue;
+
+			for (int y = 0; y < 2; ++y) {
+				reference::strategy si;
+				si.immunization = y;
+				for (int j = 0; j < n; ++j) {
+					if (mask & (1 << j))
+						si.bought.push_back(j);
+				}
+				best = max(best, ref.getUtility(i, si, in.ce, in.ci, in.adv2attacks));
+			}
+		}
+
+		if (fabs(u - best) > 1e-9) {
+			stringstream ss;
+			ss << "full best response of player " << i << " has utility " << u << ", best " << best;
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Compares the final strategy profile of the dynamics with the reference one.
+*/
+string testDynamics(instance &in) {
+	Model model(in.s);
+	reference::Model ref = referenceModel(in);
+
+	model.dynamics(in.ce, in.ci, in.adv2attacks);
+	ref.dynamics(in.ce, in.ci, in.adv2attacks);
+
+	vector<strategy> s = model.getStrategyProfile();
+	vector<reference::strategy> rs = ref.getStrategyProfile();
+
+	for (int i = 0; i < s.size(); ++i) {
+		if (not sameStrategy(s[i].bought, s[i].immunization, rs[i].bought, rs[i].immunization)) {
+			stringstream ss;
+			ss << "final strategy of player " << i << " differs from the reference";
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Checks that the final strategy profile of the dynamics with better responses is a swapstable equilibrium
+	according to the reference.
+*/
+string testBetterResponseDynamics(instance &in) {
+	Model model(in.s);
+	model.dynamics(in.ce, in.ci, in.adv2attacks, BETTER);
+
+	instance fin = in;
+	fin.s = model.getStrategyProfile();
+	reference::Model ref = referenceModel(fin);
+
+	for (int i = 0; i < fin.s.size(); ++i) {
+		reference::strategy rbr = ref.getSwapstableBR(i, in.ce, in.ci, in.adv2attacks);
+		if (not sameStrategy(fin.s[i].bought, fin.s[i].immunization, rbr.bought, rbr.immunization)) {
+			stringstream ss;
+			ss << "final strategy profile is not an equilibrium: player " << i << " improves";
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Checks that the simultaneous-move dynamics gives the same final strategy profile with 1 and 4 threads, and
+	that it is a swapstable equilibrium according to the reference.
+*/
+string testSimultaneousDynamics(instance &in) {
+	Model model1(in.s), model4(in.s);
+
+	dynamicsStats stats = model1.simultaneousDynamics(in.ce, in.ci, in.adv2attacks, 0.5, 1, 1000, 1);
+	model4.simultaneousDynamics(in.ce, in.ci, in.adv2attacks, 0.5, 1, 1000, 4);
+
+	if (not stats.converged)
+		return ""; //Nothing to compare
+
+	instance fin = in;
+	fin.s = model1.getStrategyProfile();
+	vector<strategy> s4 = model4.getStrategyProfile();
+	reference::Model ref = referenceModel(fin);
+
+	for (int i = 0; i < fin.s.size(); ++i) {
+		if (not sameStrategy(fin.s[i].bought, fin.s[i].immunization, s4[i].bought, s4[i].immunization))
+			return "final strategy profiles with 1 and 4 threads differ";
+
+		reference::strategy rbr = ref.getSwapstableBR(i, in.ce, in.ci, in.adv2attacks);
+		if (not sameStrategy(fin.s[i].bought, fin.s[i].immunization, rbr.bought, rbr.immunization)) {
+			stringstream ss;
+			ss << "final strategy profile is not an equilibrium: player " << i << " improves";
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Compares the utilities, the swapstable best responses and the final strategy profile of the dynamics of a
+	model that relabels its nodes every round with the reference ones.
+*/
+string testRelabeling(instance &in) {
+	Model model(in.s);
+	model.setRelabeling(Relabeling(in.s.size() % 3 + 1), 1); //Cycles through the orders
+	reference::Model ref = referenceModel(in);
+
+	vector<double> u = model.calculateUtilities(in.ce, in.ci, in.adv2attacks);
+	for (int i = 0; i < in.s.size(); ++i) {
+		double ru = ref.getUtility(i, in.ce, in.ci, in.adv2attacks);
+		if (u[i] != ru) {
+			stringstream ss;
+			ss << "utility of player " << i << ": " << u[i] << ", reference " << ru;
+			return ss.str();
+		}
+
+		strategy br = model.bestResponse(i, in.ce, in.ci, in.adv2attacks, SWAPSTABLE);
+		reference::strategy rbr = ref.getSwapstableBR(i, in.ce, in.ci, in.adv2attacks);
+		if (not sameStrategy(br.bought, br.immunization, rbr.bought, rbr.immunization)) {
+			stringstream ss;
+			ss << "swapstable best response of player " << i << " differs from the reference";
+			return ss.str();
+		}
+	}
+
+	model.dynamics(in.ce, in.ci, in.adv2attacks);
+	ref.dynamics(in.ce, in.ci, in.adv2attacks);
+
+	vector<strategy> s = model.getStrategyProfile();
+	vector<reference::strategy> rs = ref.getStrategyProfile();
+	for (int i = 0; i < s.size(); ++i) {
+		if (not sameStrategy(s[i].bought, s[i].immunization, rs[i].bought, rs[i].immunization)) {
+			stringstream ss;
+			ss << "final strategy of player " << i << " differs from the reference";
+			return ss.str();
+		}
+	}
+	return "";
+}
+
+/**
+	Compares the better and full best responses and the final strategy profiles of the dynamics with them of
+	models that relabel their nodes every round, in each order, with those of a model that does not relabel
+	them. The full best responses are only compared with at most 7 players.
+*/
+string testRelabeledResponses(instance &in) {
+	int n = in.s.size();
+	ResponseMode modes[] = {BETTER, FULL};
+	Relabeling orders[] = {BFS_ORDER, RCM_ORDER, DEGREE_ORDER};
+
+	for (int k = 0; k < 2; ++k) {
+		if (modes[k] == FULL and n > 7)
+			continue; //Too slow
+
+		Model plain(in.s);
+		vector<strategy> br(n);
+		for (int i = 0; i < n; ++i)
+			br[i] = plain.bestResponse(i, in.ce, in.ci, in.adv2attacks, modes[k]);
+		plain.dynamics(in.ce, in.ci, in.adv2attacks, modes[k]);
+		vector<strategy> s = plain.getStrategyProfile();
+
+		for (int o = 0; o < 3; ++o) {
+			Model model(in.s);
+			model.setRelabeling(orders[o], 1);
+
+			for (int i = 0; i < n; ++i) {
+				strategy rbr = model.bestResponse(i, in.ce, in.ci, in.adv2attacks, modes[k]);
+				if (not sameStrategy(rbr.bought, rbr.immunization, br[i].bought, br[i].immunization)) {
+					stringstream ss;
+					ss << (modes[k] == FULL ? "full" : "better") << " response of player " << i
+					   << " differs with the order " << orders[o];
+					return ss.str();
+				}
+			}
+
+			model.dynamics(in.ce, in.ci, in.adv2attacks, modes[k]);
+			vector<strategy> rs = model.getStrategyProfile();
+			for (int i = 0; i < n; ++i) {
+				if (not sameStrategy(rs[i].bought, rs[i].immunization, s[i].bought, s[i].immunization)) {
+					stringstream ss;
+					ss << "final strategy of player " << i << " with " << (modes[k] == FULL ? "full" : "better")
+					   << " responses differs with the order " << orders[o];
+					return ss.str();
+				}
+			}
+		}
+	}
+	return "";
+}
+
+/**
+	Returns the instance without the player k.
+
+	@param in An instance.
+	@param k A player.
+	@returns The instance without k and her edges, where the players after k are renumbered.
+*/
+instance removePlayer(instance in, int k) {
+	in.s.erase(in.s.begin() + k);
+	for (int i = 0; i < in.s.size(); ++i) {
+		in.s[i].bought.remove(k);
+
+		list<int>::iterator it;
+		for (it = in.s[i].bought.begin(); it != in.s[i].bought.end(); ++it) {
+			if (*it > k)
+				--(*it);
+		}
+	}
+	return in;
+}
+
+/**
+	Shrinks an instance that fails a test, removing players, edges and immunizations while it still fails.
+
+	@param in The failing instance.
+	@param test The test.
+	@returns A failing instance where removing any player, edge or immunization makes the test pass.
+*/
+instance shrink(instance in, Test test) {
+	bool shrunk = true;
+	while (shrunk) {
+		shrunk = false;
+
+		for (int k = in.s.size() - 1; k >= 0 and in.s.size() > 1; --k) {
+			instance cand = removePlayer(in, k);
+			if (test(cand) != "") {
+				in = cand;
+				shrunk = true;
+			}
+		}
+
+		for (int i = 0; i < in.s.size(); ++i) {
+			list<int> bought = in.s[i].bought;
+			list<int>::iterator it;
+			for (it = bought.begin(); it != bought.end(); ++it) {
+				instance cand = in;
+				cand.s[i].bought.remove(*it);
+				if (test(cand) != "") {
+					in = cand;
+					shrunk = true;
+				}
+			}
+
+			if (in.s[i].immunization) {
+				instance cand = in;
+				cand.s[i].immunization = false;
+				if (test(cand) != "") {
+					in = cand;
+					shrunk = true;
+				}
+			}
+		}
+	}
+	return in;
+}
+
+
+int main(int argc, char *argv[]) {
+	int nInstances = (argc > 1) ? atoi(argv[1]) : 200;
+	unsigned int firstSeed = (argc > 2) ? atoi(argv[2]) : 1;
+
+	struct {
+		const char *name;
+		Test test;
+		int maxN;
+	} tests[] = {
+		{"utilities", testUtilities, 12},
+		{"swapstable best responses", testSwapstableBR, 10},
+		{"full best responses", testFullBR, 7},
+		{"dynamics", testDynamics, 10},
+		{"better-response dynamics", testBetterResponseDynamics, 10},
+		{"simultaneous-move dynamics", testSimultaneousDynamics, 10},
+		{"relabeled nodes", testRelabeling, 10},
+		{"relabeled better and full responses", testRelabeledResponses, 10}
+	};
+	int nTests = sizeof(tests) / sizeof(tests[0]);
+
+	int failures = 0;
+	for (int t = 0; t < nTests; ++t) {
+		int testFailures = 0;
+
+		for (int k = 0; k < nInstances; ++k) {
+			unsigned int seed = firstSeed + k;
+			instance in = randomInstance(seed, tests[t].maxN);
+
+			if (tests[t].test(in) != "") {
+				++testFailures;
+				instance min = shrink(in, tests[t].test);
+				cout << tests[t].name << ", seed " << seed << ": " << tests[t].test(min) << endl;
+				cout << "Minimal instance: ";
+				printInstance(cout, min);
+			}
+		}
+
+		cout << tests[t].name << ": " << nInstances - testFailures << "/" << nInstances << " passed" << endl;
+		failures += testFailures;
+	}
+
+	return (failures > 0) ? 1 : 0;
+}
@@ -1,15 +1,27 @@
+#include <algorithm>
 #include "graph.h"
+#include "profiler.h"
 
 
 Graph::Graph(int n) {
 	edges = AdjacencyList(n);
 }
 
+Graph::Graph(const Graph &g) {
+	countProfiledCall(GRAPH_COPY);
+	edges = g.edges;
+}
+
+Graph &Graph::operator=(const Graph &g) {
+	countProfiledCall(GRAPH_COPY);
+	edges = g.edges;
+	return *this;
+}
+
 bool Graph::existsEdge(int i, int j) {
-	list<int> e = edges[j];
-	list<int>::iterator it;
-	for (it = e.begin(); it != e.end(); ++it) {
-		if (i == *it)
+	vector<int> &e = edges[j];
+	for (int k = 0; k < e.size(); ++k) {
+		if (i == e[k])
 			return true;
 	}
 	return false;
@@ -23,29 +35,34 @@ void Graph::addEdge(int i, int j) {
 }
 
 void Graph::dropEdge(int i, int j) {
-	edges[i].remove(j);
-	edges[j].remove(i);
+	edges[i].erase(remove(edges[i].begin(), edges[i].end(), j), edges[i].end());
+	edges[j].erase(remove(edges[j].begin(), edges[j].end(), i), edges[j].end());
 }
 
-list<int> Graph::getEdges(int i) {
+const vector<int> &Graph::getEdges(int i) {
 	return edges[i];
 }
 
 bool Graph::isDeleted(int i) {
-	list<int> e = edges[i];
-	return (e.begin() != e.end() and *(e.begin()) == -1);
+	return (not edges[i].empty() and edges[i][0] == -1);
 }
 
 void Graph::deleteNode(int i) {
+	if (isDeleted(i))
+		return;
+
+	//Only the neighbours of i have i in their edges
+	for (int k = 0; k < edges[i].size(); ++k) {
+		vector<int> &e = edges[edges[i][k]];
+		e.erase(remove(e.begin(), e.end(), i), e.end());
+	}
+
 	edges[i].clear();
 	edges[i].push_back(-1);
-
-	for (int j = 0; j < edges.size(); j++)
-		edges[j].remove(i);
 }
 
-void Graph::deleteNodes(list<int> l) {
-	list<int>::iterator it;
+void Graph::deleteNodes(const list<int> &l) {
+	list<int>::const_iterator it;
 	for (it = l.begin(); it != l.end(); ++it)
 		deleteNode(*it);
 }
\ No newline at end of file
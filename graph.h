@@ -2,17 +2,22 @@
 	Represents an undirected graph.
 */
 
+#ifndef GRAPH_H
+#define GRAPH_H
+
 #include <list>
 #include <vector>
 using namespace std;
 
-typedef vector<list <int> > AdjacencyList;
+typedef vector<vector<int> > AdjacencyList;
 
 
 class Graph {
 
 	private:
-		///For each node i, contains a list of the nodes j such that exists (i,j), or a -1 if i has been deleted.
+		///For each node i, contains the nodes j such that exists (i,j), in the order the edges were added, or a
+		///-1 if i has been deleted. Each node has a contiguous array, so traversing the nodes in the order of
+		///their numbers visits their neighbours without chasing list pointers.
 		AdjacencyList edges;
 
 	public:
@@ -23,6 +28,25 @@ class Graph {
 		*/
 		Graph(int n);
 
+		/**
+			Creates a copy of the graph g.
+
+			@param g A graph.
+		*/
+		Graph(const Graph &g);
+
+		Graph(Graph &&g) = default;
+
+		/**
+			Makes this graph a copy of the graph g.
+
+			@param g A graph.
+			@returns This graph.
+		*/
+		Graph &operator=(const Graph &g);
+
+		Graph &operator=(Graph &&g) = default;
+
 		/**
 			Says whether there exists an edge (i,j).
 
@@ -46,12 +70,12 @@ class Graph {
 		void dropEdge(int i, int j);
 
 		/**
-			Returns the list of nodes connected to i.
+			Returns the nodes connected to i, without copying them.
 
 			@param i A node.
-			@returns The list of nodes j such that exists (i,j).
+			@returns The nodes j such that exists (i,j), valid until the graph changes.
 		*/
-		list<int> getEdges(int i);
+		const vector<int> &getEdges(int i);
 
 		/**
 			Says whether the node i has been deleted from the graph.
@@ -73,5 +97,7 @@ class Graph {
 			
 			@param i A list of nodes.
 		*/
-		void deleteNodes(list<int> l);
-};
\ No newline at end of file
+		void deleteNodes(const list<int> &l);
+};
+
+#endif
\ No newline at end of file
@@ -1,10 +1,327 @@
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include "model.h"
+#include "analytics.h"
+#include "parallel.h"
+#include "profiler.h"
 #include "assert.h"
 using namespace std;
 
-int main() {
+/**
+	Writes a strategy to the output stream.
+
+	@param os The output stream.
+	@param si A strategy.
+*/
+void printStrategy(ostream &os, strategy si) {
+	os << "buys {";
+	list<int>::iterator it;
+	for (it = si.bought.begin(); it != si.bought.end(); ++it) {
+		if (it != si.bought.begin())
+			os << ",";
+		os << *it;
+	}
+	os << "}, " << (si.immunization ? "immunized" : "vulnerable");
+}
+
+/**
+	Checks whether the strategy profiles stored in some files are swapstable equilibria, and writes the
+	improving deviations found.
+
+	@param files The names of the files, with the format of Model::exportGraph.
+	@param ce The cost of the edges.
+	@param ci The immunization cost.
+	@param adv2attacks The adversary (true for the one that makes 2 attacks)
+	@param nThreads The number of threads.
+	@param stopAtFirst If true, only says whether each profile is an equilibrium.
+	@returns The number of profiles that are not equilibria, or cannot be read, or are malformed.
+*/
+int verify(list<string> files, double ce, double ci, bool adv2attacks, int nThreads, bool stopAtFirst) {
+	int nonEquilibria = 0;
+
+	list<string>::iterator it;
+	for (it = files.begin(); it != files.end(); ++it) {
+		vector<strategy> s;
+		string error;
+		if (not Model::readStrategyProfile(*it, s, error)) {
+			cerr << *it << ": " << error << endl;
+			++nonEquilibria;
+			continue;
+		}
+
+		Model model(s);
+		list<deviation> dev = model.verifyEquilibrium(ce, ci, adv2attacks, nThreads, stopAtFirst);
+
+		if (dev.empty())
+			cout << *it << ": equilibrium" << endl;
+		else {
+			cout << *it << ": not an equilibrium" << endl;
+			++nonEquilibria;
+		}
+
+		if (not stopAtFirst) {
+			list<deviation>::iterator d;
+			for (d = dev.begin(); d != dev.end(); ++d) {
+				cout << "\tplayer " << d->player << " deviates to: ";
+				printStrategy(cout, d->improving);
+				cout << ", gains " << d->gap << endl;
+			}
+		}
+	}
+	cout << nonEquilibria << " of " << files.size() << " profiles are not equilibria, cannot be read or are malformed" << endl;
+	return nonEquilibria;
+}
+
+///The options of the dynamics:
+struct options {
+	ResponseMode mode;
+	double timeBudget;
+	bool jacobi;
+	double lambda;
+	unsigned int seed;
+	int maxRounds;
+	int nThreads;
+	Relabeling relabeling;
+	int relabelPeriod;
+};
+
+/**
+	Returns the suffix of the names of the files written with some options of the dynamics, so that the results
+	of each kind of dynamics are kept apart.
+
+	@param opt The options of the dynamics.
+	@returns The suffix.
+*/
+string modeSuffix(options opt) {
+	string suffix;
+	if (opt.mode == FULL)
+		suffix += "_fullBR";
+	else if (opt.mode == BETTER)
+		suffix += "_betterBR";
+	if (opt.jacobi)
+		suffix += "_jacobi";
+	return suffix;
+}
+
+/**
+	Runs the dynamics from the current strategy profile of the model, exports the final graph and writes its
+	social welfare.
+
+	@param model The model.
+	@param ce The cost of the edges.
+	@param ci The immunization cost.
+	@param adv2attacks The adversary (true for the one that makes 2 attacks)
+	@param opt The options of the dynamics.
+	@param nameFileFinal The name of the file of the final graph, without the extension.
+	@returns The statistics of the run.
+*/
+dynamicsStats runDynamics(Model &model, double ce, double ci, bool adv2attacks, options opt, string nameFileFinal) {
+	dynamicsStats stats;
+
+	stringstream label; //The run in the profile
+	label << "ce" << ce << "_ci" << ci;
+	startProfiledRun(label.str());
+
+	if (opt.relabeling != NO_RELABELING)
+		model.setRelabeling(opt.relabeling, opt.relabelPeriod);
+
+	if (opt.jacobi) {
+		stats = model.simultaneousDynamics(ce, ci, adv2attacks, opt.lambda, opt.seed, opt.maxRounds, opt.nThreads, opt.mode, opt.timeBudget);
+		if (not stats.converged)
+			cout << "The simultaneous-move dynamics has not converged in " << opt.maxRounds << " rounds" << endl;
+	}
+	else
+		stats = model.dynamics(ce, ci, adv2attacks, opt.mode, opt.timeBudget);
+
+	model.exportGraph(nameFileFinal + modeSuffix(opt) + ".csv");
+
+	if (model.getFullBRGap() > 0)
+		cout << "Some full best responses ran out of time. Largest gap to the certified bound: " << model.getFullBRGap() << endl;
+
+	cout << "Social welfare: " << model.calculateSocialWelfare(ce, ci, adv2attacks) << endl;
+
+	return stats;
+}
+
+/**
+	Exports the measures of the profiled kernels as a csv file, and says if they only have the wall-clock times.
+
+	@param nameFile The name of the file.
+*/
+void exportProfile(string nameFile) {
+	if (not writeProfile(nameFile))
+		cout << "The hardware counters are not available, so the profile only has the wall-clock times" << endl;
+}
+
+/**
+	Returns an order of the points of the costs grid to run a continuation sweep: starting from the first one,
+	the next point is always the nearest one not visited yet.
+
+	@param points The pairs of costs (Ce, Ci).
+	@returns The indices of the points in the order of the sweep.
+*/
+vector<int> continuationPath(vector<pair<double, double> > &points) {
+	vector<int> path;
+	vector<bool> visited(points.size(), false);
+
+	int cur = 0;
+	while (path.size() < points.size()) {
+		visited[cur] = true;
+		path.push_back(cur);
+
+		int next = -1;
+		double minDist = 0;
+		for (int k = 0; k < points.size(); ++k) {
+			double dce = points[k].first - points[cur].first;
+			double dci = points[k].second - points[cur].second;
+			double dist = dce*dce + dci*dci;
+			if (not visited[k] and (next == -1 or dist < minDist)) {
+				next = k;
+				minDist = dist;
+			}
+		}
+		cur = next;
+	}
+	return path;
+}
+
+/**
+	Runs the dynamics for each pair of costs Ce and Ci entered, always starting from the same random initial graph.
+
+	Options:
+		--full-br [seconds] The players compute full best responses instead of swapstable ones, with the given
+		                    time budget for each of them (no limit by default).
+		--better-br         The players adopt the first swapstable deviation that improves their utility,
+		                    instead of the best one.
+		--jacobi [lambda]   Runs the simultaneous-move dynamics, where each player with an improving best
+		                    response adopts it with probability lambda (0.5 by default).
+		--seed s            The seed of the random choices of the simultaneous-move dynamics (1 by default).
+		--max-rounds r      The maximum number of rounds of the simultaneous-move dynamics (1000 by default).
+		--threads k         The number of threads of the parallel computations (all the hardware threads by
+		                    default).
+		--relabel order [r] Renumbers the nodes of the graph in the given order (bfs, rcm or degree) to
+		                    improve the locality of the traversals, again every r rounds (only at the start by
+		                    default). The results are the same.
+		--profile           Measures the cycles, instructions, last-level cache misses and branch misses of the
+		                    hot kernels (only the wall-clock time when the hardware counters are not
+		                    available), by pair of costs and round of the dynamics, and exports them to a
+		                    profile csv file.
+		--continuation      Reads all the pairs of costs first, and sweeps them along a path of nearest
+		                    neighbours. Each dynamics starts from the final graph of the nearest pair already
+		                    swept, instead of the random initial graph. The final graphs are suffixed with
+		                    "_warm", and the pair each one started from and its statistics are written to a
+		                    continuation csv file.
+
+	With --verify ce ci adversary [--any] file..., instead checks whether the strategy profiles stored in the
+	files are swapstable equilibria for the costs ce and ci and the adversary (1 or 2 attacks), writes the
+	number of profiles that are not, and exits with 1 if there is any. With --any, only says whether each of
+	them is an equilibrium.
+
+	With --analyze ce ci summary file..., instead computes the statistics of the strategy profiles stored in
+	the files, for the costs ce and ci, and exports them to the csv file summary. The files that cannot be read
+	or are malformed are reported and skipped, and then it exits with 1.
+*/
+int main(int argc, char *argv[]) {
+	options opt;
+	opt.mode = SWAPSTABLE;
+	opt.timeBudget = 0;
+	opt.jacobi = false;
+	opt.lambda = 0.5;
+	opt.seed = 1;
+	opt.maxRounds = 1000;
+	opt.nThreads = defaultNumThreads();
+	opt.relabeling = NO_RELABELING;
+	opt.relabelPeriod = 0;
+
+	bool continuation = false;
+
+	bool verifyMode = false;
+	double verifyCe, verifyCi;
+	int verifyAdversary;
+	bool stopAtFirst = false;
+	list<string> files;
+
+	bool analyzeMode = false;
+	double analyzeCe, analyzeCi;
+	string nameFileSummary;
+
+	for (int a = 1; a < argc; ++a) {
+		if (strcmp(argv[a], "--full-br") == 0) {
+			opt.mode = FULL;
+			if (a + 1 < argc and argv[a + 1][0] != '-')
+				opt.timeBudget = atof(argv[++a]);
+		}
+		else if (strcmp(argv[a], "--better-br") == 0)
+			opt.mode = BETTER;
+		else if (strcmp(argv[a], "--jacobi") == 0) {
+			opt.jacobi = true;
+			if (a + 1 < argc and argv[a + 1][0] != '-')
+				opt.lambda = atof(argv[++a]);
+			assert(opt.lambda > 0 and opt.lambda <= 1);
+		}
+		else if (strcmp(argv[a], "--seed") == 0 and a + 1 < argc)
+			opt.seed = atoi(argv[++a]);
+		else if (strcmp(argv[a], "--max-rounds") == 0 and a + 1 < argc) {
+			opt.maxRounds = atoi(argv[++a]);
+			assert(opt.maxRounds > 0);
+		}
+		else if (strcmp(argv[a], "--threads") == 0 and a + 1 < argc) {
+			opt.nThreads = atoi(argv[++a]);
+			assert(opt.nThreads > 0);
+		}
+		else if (strcmp(argv[a], "--relabel") == 0 and a + 1 < argc) {
+			++a;
+			if (strcmp(argv[a], "bfs") == 0)
+				opt.relabeling = BFS_ORDER;
+			else if (strcmp(argv[a], "rcm") == 0)
+				opt.relabeling = RCM_ORDER;
+			else if (strcmp(argv[a], "degree") == 0)
+				opt.relabeling = DEGREE_ORDER;
+			else {
+				cerr << "Unknown order " << argv[a] << endl;
+				return 1;
+			}
+			if (a + 1 < argc and argv[a + 1][0] != '-')
+				opt.relabelPeriod = atoi(argv[++a]);
+			assert(opt.relabelPeriod >= 0);
+		}
+		else if (strcmp(argv[a], "--profile") == 0)
+			startProfiling();
+		else if (strcmp(argv[a], "--continuation") == 0)
+			continuation = true;
+		else if (strcmp(argv[a], "--verify") == 0 and a + 3 < argc) {
+			verifyMode = true;
+			verifyCe = atof(argv[++a]);
+			verifyCi = atof(argv[++a]);
+			verifyAdversary = atoi(argv[++a]);
+			assert(verifyCe >= 0 and verifyCi >= 0);
+			assert(verifyAdversary == 1 or verifyAdversary == 2);
+		}
+		else if (strcmp(argv[a], "--any") == 0)
+			stopAtFirst = true;
+		else if (strcmp(argv[a], "--analyze") == 0 and a + 3 < argc) {
+			analyzeMode = true;
+			analyzeCe = atof(argv[++a]);
+			analyzeCi = atof(argv[++a]);
+			nameFileSummary = argv[++a];
+			assert(analyzeCe >= 0 and analyzeCi >= 0);
+		}
+		else if ((verifyMode or analyzeMode) and argv[a][0] != '-')
+			files.push_back(argv[a]);
+		else {
+			cerr << "Unknown option " << argv[a] << endl;
+			return 1;
+		}
+	}
+
+	if (verifyMode)
+		return (verify(files, verifyCe, verifyCi, verifyAdversary == 2, opt.nThreads, stopAtFirst) > 0) ? 1 : 0;
+
+	if (analyzeMode) {
+		return (analyzeProfiles(files, analyzeCe, analyzeCi, opt.nThreads, nameFileSummary) > 0) ? 1 : 0;
+	}
+
 	int n, m;
 	cout << "Enter number of nodes of the graph:" << endl;
 	cin >> n;
@@ -32,19 +349,94 @@ int main() {
 	assert(adversary == 1 or adversary == 2);
 	bool adv2attacks = (adversary == 2);
 
+	//The statistics of the runs, in a file for each kind of dynamics
+	stringstream nameFileStats;
+	nameFileStats << "stats_n" << n << "_m" << m << "_p" << p << "_" << adversary << "attacks" << modeSuffix(opt) << (continuation ? "_warm" : "") << ".csv";
+	ofstream statsFile;
+	statsFile.open(nameFileStats.str());
+	statsFile << "ce,ci,rounds,moves,converged,seconds" << endl;
+
+	//The measures of the kernels in all the runs, if they are profiled
+	stringstream nameFileProfile;
+	nameFileProfile << "profile_n" << n << "_m" << m << "_p" << p << "_" << adversary << "attacks" << modeSuffix(opt) << (continuation ? "_warm" : "") << ".csv";
+
 	double ce, ci;
+
+	if (continuation) {
+		vector<pair<double, double> > points;
+		cout << "Enter non-negative Ce and Ci, a pair per line, until the end of the input:" << endl;
+		while (cin >> ce >> ci) {
+			assert(ce >= 0 and ci >= 0);
+			points.push_back(make_pair(ce, ci));
+		}
+
+		stringstream nameFileContinuation;
+		nameFileContinuation << "continuation_n" << n << "_m" << m << "_p" << p << "_" << adversary << "attacks" << modeSuffix(opt) << ".csv";
+		ofstream myfile;
+		myfile.open(nameFileContinuation.str());
+		myfile << "ce,ci,start_ce,start_ci,rounds,moves" << endl;
+
+		vector<Model> finalModels; //The final models of the pairs already swept
+		vector<int> swept; //The pairs already swept
+
+		vector<int> path = continuationPath(points);
+		for (int k = 0; k < path.size(); ++k) {
+			ce = points[path[k]].first;
+			ci = points[path[k]].second;
+
+			int start = -1; //The nearest pair already swept
+			double minDist = 0;
+			for (int q = 0; q < swept.size(); ++q) {
+				double dce = points[swept[q]].first - ce;
+				double dci = points[swept[q]].second - ci;
+				double dist = dce*dce + dci*dci;
+				if (start == -1 or dist < minDist) {
+					start = q;
+					minDist = dist;
+				}
+			}
+
+			model = (start == -1) ? auxModel : finalModels[start];
+
+			cout << "Ce = " << ce << ", Ci = " << ci << endl;
+			stringstream nameFileFinal;
+			nameFileFinal << "final_graph_n" << n << "_m" << m << "_p" << p << "_ce" << ce << "_ci" << ci << "_" << adversary << "attacks_warm";
+			dynamicsStats stats = runDynamics(model, ce, ci, adv2attacks, opt, nameFileFinal.str());
+			statsFile << ce << "," << ci << "," << stats.rounds << "," << stats.moves << "," << stats.converged << "," << stats.seconds << endl;
+
+			myfile << ce << "," << ci << ",";
+			if (start == -1)
+				myfile << "initial,initial";
+			else
+				myfile << points[swept[start]].first << "," << points[swept[start]].second;
+			myfile << "," << stats.rounds << "," << stats.moves << endl;
+
+			finalModels.push_back(model);
+			swept.push_back(path[k]);
+		}
+
+		myfile.close();
+		statsFile.close();
+		if (profiling)
+			exportProfile(nameFileProfile.str());
+		return 0;
+	}
+
 	cout << "Enter non-negative Ce and Ci:" << endl;
 	while (cin >> ce >> ci) {
 		assert(ce >= 0 and ci >= 0);
 
 		model = auxModel;
 
-		model.dynamics(ce, ci, adv2attacks);
-
 		stringstream nameFileFinal;
-		nameFileFinal << "final_graph_n" << n << "_m" << m << "_p" << p << "_ce" << ce << "_ci" << ci << "_" << adversary << "attacks.csv";
-		model.exportGraph(nameFileFinal.str());
+		nameFileFinal << "final_graph_n" << n << "_m" << m << "_p" << p << "_ce" << ce << "_ci" << ci << "_" << adversary << "attacks";
+		dynamicsStats stats = runDynamics(model, ce, ci, adv2attacks, opt, nameFileFinal.str());
+		statsFile << ce << "," << ci << "," << stats.rounds << "," << stats.moves << "," << stats.converged << "," << stats.seconds << endl;
 
 		cout << "Enter non-negative Ce and Ci:" << endl;
 	}
+
+	statsFile.close();
+	if (profiling)
+		exportProfile(nameFileProfile.str());
 }
\ No newline at end of file
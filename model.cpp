@@ -1,13 +1,98 @@
+#include <algorithm>
+#include <random>
+#include <sstream>
 #include "model.h"
+#include "parallel.h"
+#include "profiler.h"
 
-Model::Model(int n, int m, double p) : graph(n)
+Model::Model(int n, int m, double p) : graph(n), relabeling(NO_RELABELING), relabelPeriod(0), timeBudget(0), fullBRGap(0)
 {
 	s = vector<strategy>(n);
+	initNodes();
 
 	initImmunizations(p);
 	initEdges(m);
 }
 
+Model::Model(vector<strategy> s) : graph(s.size()), relabeling(NO_RELABELING), relabelPeriod(0), timeBudget(0), fullBRGap(0)
+{
+	this->s = vector<strategy>(s.size());
+	initNodes();
+
+	for (int i = 0; i < s.size(); ++i) {
+		this->s[i].immunization = s[i].immunization;
+
+		list<int>::iterator it;
+		for (it = s[i].bought.begin(); it != s[i].bought.end(); ++it)
+			buyEdge(this->s[i], graph, i, *it);
+	}
+}
+
+void Model::setRelabeling(Relabeling relabeling, int period) {
+	this->relabeling = relabeling;
+	relabelPeriod = period;
+	relabel();
+}
+
+bool Model::readStrategyProfile(string nameFile, vector<strategy> &s, string &error) {
+	ifstream myfile;
+	myfile.open(nameFile);
+	if (not myfile.good()) {
+		error = "cannot be read";
+		return false;
+	}
+
+	int n;
+	if (not (myfile >> n) or n <= 0) {
+		error = "the number of players is missing or not positive";
+		return false;
+	}
+
+	s = vector<strategy>(n);
+	vector<bool> read(n, false); //The players whose row has been read
+
+	for (int k = 0; k < n; ++k) {
+		stringstream ss;
+
+		int i;
+		char comma;
+		bool y;
+		if (not (myfile >> i >> comma >> y) or comma != ',') {
+			ss << "row " << k + 1 << " of " << n << " is missing or malformed";
+			error = ss.str();
+			return false;
+		}
+		if (i < 0 or i >= n or read[i]) {
+			ss << "row " << k + 1 << " has an invalid or repeated player " << i;
+			error = ss.str();
+			return false;
+		}
+		read[i] = true;
+		s[i].immunization = y;
+
+		int j;
+		while (true) {
+			if (not (myfile >> comma >> j) or comma != ',') {
+				ss << "the row of player " << i << " is malformed or not ended with -1";
+				error = ss.str();
+				return false;
+			}
+			if (j == -1)
+				break;
+
+			if (j < 0 or j >= n or j == i) {
+				ss << "player " << i << " buys an edge to the invalid player " << j;
+				error = ss.str();
+				return false;
+			}
+			s[i].bought.push_back(j);
+		}
+	}
+
+	myfile.close();
+	return true;
+}
+
 void Model::exportGraph(string nameFile) {
 	ofstream myfile;
 	myfile.open(nameFile);
@@ -16,9 +101,9 @@ void Model::exportGraph(string nameFile) {
 	for (int i = 0; i < s.size(); ++i) {
 		myfile << i << "," ;
 
-		myfile << s[i].immunization;
+		myfile << s[nodeOf[i]].immunization;
 
-		list<int> bought = s[i].bought;
+		list<int> bought = toPlayers(s[nodeOf[i]]).bought;
 		list<int>::iterator it;
 		for (it = bought.begin(); it != bought.end(); ++it) {
 			myfile << "," << *it;
@@ -30,30 +115,243 @@ void Model::exportGraph(string nameFile) {
 	myfile.close();
 }
 
-void Model::dynamics(double ce, double ci, bool adv2attacks) {
+dynamicsStats Model::dynamics(double ce, double ci, bool adv2attacks, ResponseMode mode, double timeBudget) {
 	this->ce = ce;
 	this->ci = ci;
 	this->adv2attacks = adv2attacks;
+	this->timeBudget = timeBudget;
+	fullBRGap = 0;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	dynamicsStats stats;
+	stats.rounds = 0;
+	stats.moves = 0;
 
 	bool equilibrium;
 	do {
 		equilibrium = true;
 
-		for (int i = 0; i < s.size(); ++i) {
+		if (relabelPeriod > 0 and stats.rounds > 0 and stats.rounds % relabelPeriod == 0)
+			relabel();
+
+		++stats.rounds;
+		setProfiledRound(stats.rounds);
+
+		for (int k = 0; k < s.size(); ++k) {
+			int i = nodeOf[k]; //The players play in their order, whatever the order of the nodes
 			strategy si = s[i];
-			pair<strategy, Graph> swBR = swapstableBR(i);
-			strategy sbr = swBR.first;
+			double gap;
+			pair<strategy, Graph> BR = response(i, mode, gap);
+			fullBRGap = max(fullBRGap, gap);
+
+			strategy sbr = BR.first;
 
 			bool sameStrategy =  (si.bought == sbr.bought and si.immunization == sbr.immunization);
 
 			if (not sameStrategy) {
-				equilibrium = false; //The strategy profile s is not a swapstable equilibrium
+				equilibrium = false; //The strategy profile s is not an equilibrium
 				s[i] = sbr;
-				graph = swBR.second;
+				graph = BR.second;
+				++stats.moves;
 			}
 		}
 	}
 	while (not equilibrium);
+
+	setProfiledRound(0); //Outside the rounds
+	stats.converged = true;
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+double Model::getFullBRGap() {
+	return fullBRGap;
+}
+
+strategy Model::bestResponse(int i, double ce, double ci, bool adv2attacks, ResponseMode mode, double timeBudget) {
+	this->ce = ce;
+	this->ci = ci;
+	this->adv2attacks = adv2attacks;
+	this->timeBudget = timeBudget;
+
+	double gap;
+	return toPlayers(response(nodeOf[i], mode, gap).first);
+}
+
+dynamicsStats Model::simultaneousDynamics(double ce, double ci, bool adv2attacks, double lambda, unsigned int seed,
+                                          int maxRounds, int nThreads, ResponseMode mode, double timeBudget) {
+	this->ce = ce;
+	this->ci = ci;
+	this->adv2attacks = adv2attacks;
+	this->timeBudget = timeBudget;
+	fullBRGap = 0;
+
+	mt19937 gen(seed); //The generator of the random choices, not shared with the rest of the process
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	dynamicsStats stats;
+	stats.rounds = 0;
+	stats.moves = 0;
+	stats.converged = false;
+
+	int n = s.size();
+	vector<strategy> br(n); //The best response of each player to the strategy profile of the round
+	vector<char> improves(n); //Whether the best response of each player is different from her strategy
+	vector<double> gap(n); //The gap of each full best response
+
+	while (not stats.converged and stats.rounds < maxRounds) {
+		if (relabelPeriod > 0 and stats.rounds > 0 and stats.rounds % relabelPeriod == 0)
+			relabel();
+
+		++stats.rounds;
+		setProfiledRound(stats.rounds);
+
+		parallelFor(n, nThreads, [&](int i) {
+			pair<strategy, Graph> BR = response(i, mode, gap[i]);
+			br[i] = BR.first;
+			improves[i] = not (s[i].bought == br[i].bought and s[i].immunization == br[i].immunization);
+		});
+
+		list<int> improving; //The players with an improving best response, in their order
+		for (int k = 0; k < n; ++k) {
+			int i = nodeOf[k];
+			fullBRGap = max(fullBRGap, gap[i]);
+			if (improves[i])
+				improving.push_back(i);
+		}
+
+		if (improving.empty()) {
+			stats.converged = true; //The strategy profile s is an equilibrium
+			break;
+		}
+
+		list<int> movers; //The players that adopt their best responses this round
+		list<int>::iterator it;
+		for (it = improving.begin(); it != improving.end(); ++it) {
+			if (gen() < lambda * ((double) gen.max() + 1))
+				movers.push_back(*it);
+		}
+
+		if (movers.empty()) {
+			it = improving.begin();
+			advance(it, gen() % improving.size());
+			movers.push_back(*it);
+		}
+
+		for (it = movers.begin(); it != movers.end(); ++it) {
+			int i = *it;
+
+			list<int> bought = s[i].bought;
+			list<int>::iterator j;
+			for (j = bought.begin(); j != bought.end(); ++j)
+				dropEdge(s[i], graph, i, *j);
+
+			s[i].immunization = br[i].immunization;
+			for (j = br[i].bought.begin(); j != br[i].bought.end(); ++j)
+				buyEdge(s[i], graph, i, *j); //Not bought if a previous player has already bought it this round
+		}
+
+		stats.moves += movers.size();
+	}
+
+	setProfiledRound(0); //Outside the rounds
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+
+vector<double> Model::calculateUtilities(double ce, double ci, bool adv2attacks) {
+	this->ce = ce;
+	this->ci = ci;
+	this->adv2attacks = adv2attacks;
+
+	vector<double> u = calculateUtilities();
+
+	vector<double> up(u.size()); //The utilities by player
+	for (int i = 0; i < u.size(); ++i)
+		up[playerOf[i]] = u[i];
+	return up;
+}
+
+double Model::calculateSocialWelfare(double ce, double ci, bool adv2attacks) {
+	vector<double> u = calculateUtilities(ce, ci, adv2attacks);
+
+	double sw = 0;
+	for (int i = 0; i < u.size(); ++i)
+		sw += u[i];
+	return sw;
+}
+
+list<deviation> Model::verifyEquilibrium(double ce, double ci, bool adv2attacks, int nThreads, bool stopAtFirst) {
+	this->ce = ce;
+	this->ci = ci;
+	this->adv2attacks = adv2attacks;
+
+	vector<double> u = calculateUtilities(); //The utilities in s
+
+	vector<deviation> dev(s.size()); //For each player, her improving deviation, if she has one
+	for (int i = 0; i < s.size(); ++i)
+		dev[i].player = -1;
+
+	atomic<bool> stop(false);
+
+	parallelFor(s.size(), nThreads, [&](int i) {
+		strategy si = s[i];
+		pair<strategy, Graph> swBR = swapstableBR(i);
+		strategy sbr = swBR.first;
+
+		bool sameStrategy =  (si.bought == sbr.bought and si.immunization == sbr.immunization);
+
+		if (not sameStrategy) {
+			dev[i].player = playerOf[i];
+			dev[i].improving = toPlayers(sbr);
+			dev[i].gap = calculateUtility(i, sbr, swBR.second) - u[i];
+
+			if (stopAtFirst)
+				stop = true;
+		}
+	}, stop);
+
+	list<deviation> l;
+	for (int k = 0; k < s.size(); ++k) {
+		if (dev[nodeOf[k]].player == k)
+			l.push_back(dev[nodeOf[k]]);
+	}
+	return l;
+}
+
+vector<strategy> Model::getStrategyProfile() {
+	vector<strategy> sp(s.size()); //The strategy profile by player
+	for (int i = 0; i < s.size(); ++i)
+		sp[playerOf[i]] = toPlayers(s[i]);
+	return sp;
+}
+
+Graph Model::getGraph() {
+	Graph g(s.size()); //The graph by player
+	for (int i = 0; i < s.size(); ++i) {
+		list<int>::iterator it;
+		for (it = s[i].bought.begin(); it != s[i].bought.end(); ++it)
+			g.addEdge(playerOf[i], playerOf[*it]);
+	}
+	return g;
+}
+
+list<VulnerableRegion> Model::getVulnerableRegions() {
+	if (s.size() == 0)
+		return list<VulnerableRegion>();
+
+	list<VulnerableRegion> vr = getVulnerableRegions(0, s[0], graph); //The vulnerable regions of s are those of (s_{-0}, s_0)
+
+	list<VulnerableRegion>::iterator it;
+	for (it = vr.begin(); it != vr.end(); ++it) {
+		VulnerableRegion::iterator jt;
+		for (jt = it->begin(); jt != it->end(); ++jt)
+			*jt = playerOf[*jt];
+	}
+	return vr;
 }
 
 
@@ -101,6 +399,118 @@ void Model::initEdges(int m) {
 	}
 }
 
+void Model::initNodes() {
+	playerOf = vector<int>(s.size());
+	nodeOf = vector<int>(s.size());
+	for (int i = 0; i < s.size(); ++i)
+		playerOf[i] = nodeOf[i] = i;
+}
+
+void Model::relabel() {
+	if (relabeling == NO_RELABELING)
+		return;
+
+	int n = s.size();
+	vector<int> order = getRelabelingOrder();
+
+	vector<int> newNode(n); //For each current internal node, the new one
+	for (int k = 0; k < n; ++k)
+		newNode[order[k]] = k;
+
+	vector<strategy> ns(n);
+	Graph ng(n);
+	vector<int> nplayerOf(n);
+	for (int k = 0; k < n; ++k) {
+		strategy si = s[order[k]];
+		ns[k].immunization = si.immunization;
+
+		list<int>::iterator it;
+		for (it = si.bought.begin(); it != si.bought.end(); ++it)
+			ns[k].bought.push_back(newNode[*it]);
+
+		nplayerOf[k] = playerOf[order[k]];
+		nodeOf[nplayerOf[k]] = k;
+	}
+
+	for (int k = 0; k < n; ++k) {
+		list<int>::iterator it;
+		for (it = ns[k].bought.begin(); it != ns[k].bought.end(); ++it)
+			ng.addEdge(k, *it);
+	}
+
+	s = ns;
+	graph = ng;
+	playerOf = nplayerOf;
+}
+
+vector<int> Model::getRelabelingOrder() {
+	int n = s.size();
+	vector<int> order;
+
+	vector<int> degree(n);
+	for (int i = 0; i < n; ++i)
+		degree[i] = graph.getEdges(i).size();
+
+	if (relabeling == DEGREE_ORDER) {
+		vector<pair<int, int> > nodes; //Minus the degree, and the node
+		for (int i = 0; i < n; ++i)
+			nodes.push_back(make_pair(-degree[i], i));
+		sort(nodes.begin(), nodes.end());
+
+		for (int k = 0; k < n; ++k)
+			order.push_back(nodes[k].second);
+		return order;
+	}
+
+	//Breadth-first searches, starting each connected component from a node of minimum degree. In the
+	//Cuthill-McKee order, the neighbours of each node are visited by increasing degree
+	vector<pair<int, int> > starts; //The degree and the node
+	for (int i = 0; i < n; ++i)
+		starts.push_back(make_pair(degree[i], i));
+	sort(starts.begin(), starts.end());
+
+	vector<bool> visited(n, false);
+	for (int k = 0; k < n; ++k) {
+		int r = starts[k].second;
+		if (visited[r])
+			continue;
+
+		int head = order.size();
+		order.push_back(r);
+		visited[r] = true;
+
+		while (head < order.size()) {
+			int u = order[head++];
+			const vector<int> &edgesu = graph.getEdges(u);
+
+			vector<pair<int, int> > next; //The degree and the node of the neighbours not visited yet
+			for (int e = 0; e < edgesu.size(); ++e) {
+				int v = edgesu[e];
+				if (not visited[v]) {
+					visited[v] = true;
+					next.push_back(make_pair(relabeling == RCM_ORDER ? degree[v] : 0, v));
+				}
+			}
+			if (relabeling == RCM_ORDER)
+				sort(next.begin(), next.end());
+
+			for (int j = 0; j < next.size(); ++j)
+				order.push_back(next[j].second);
+		}
+	}
+
+	if (relabeling == RCM_ORDER)
+		reverse(order.begin(), order.end());
+	return order;
+}
+
+strategy Model::toPlayers(strategy si) {
+	list<int>::iterator it;
+	for (it = si.bought.begin(); it != si.bought.end(); ++it)
+		*it = playerOf[*it];
+	return si;
+}
+
 pair <strategy, Graph> Model::swapstableBR(int i) {
 	strategy cs = s[i]; //Current strategy of i, s_i
 	strategy bs = cs; //Best strategy of i found. Initialized to s_i
@@ -121,7 +531,321 @@ pair <strategy, Graph> Model::swapstableBR(int i) {
 	return make_pair(bs, bg);
 }
 
+pair <strategy, Graph> Model::response(int i, ResponseMode mode, double &gap) {
+	gap = 0;
+
+	if (mode == FULL) {
+		double ub; //The certified bound of the full best response
+		pair<strategy, Graph> BR = fullBR(i, ub);
+		gap = ub - calculateUtility(i, BR.first, BR.second);
+		return BR;
+	}
+
+	else if (mode == BETTER)
+		return betterResponse(i);
+
+	else
+		return swapstableBR(i);
+}
+
+pair <strategy, Graph> Model::betterResponse(int i) {
+	strategy bs = s[i]; //Best strategy of i found. Initialized to s_i
+	Graph bg = graph; //The graph corresponding to (s_{-i}, bs). Initialized to the graph corresponding to s
+
+	double cu = calculateUtility(i, bs, bg); //The utility of i in s
+	double bu = cu; //The utility of i in (s_{-i}, bs)
+
+	changeImmunizationDeviation(i, s[i], bs, graph, bg, bu);
+	if (bu > cu)
+		return make_pair(bs, bg);
+
+	list<int> drops = getDropOrder(i);
+	list<int>::iterator it;
+	{
+		ProfileScope scope(DROP_CANDIDATES);
+
+		for (it = drops.begin(); it != drops.end(); ++it) {
+			strategy cs = s[i]; //Current strategy of i, s_i
+			Graph cg = graph; //The graph corresponding to s
+
+			dropEdge(cs, cg, i, *it);
+
+			updateBestStrategy(i, cs, bs, cg, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+
+			changeImmunizationDeviation(i, cs, bs, cg, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+		}
+	}
+
+	vector<int> buys = getBuyOrder(i);
+
+	strategy ns = s[i]; //Current strategy of i, s_i
+	strategy fs = ns; //s_i with i's immunization status changed
+	fs.immunization = not fs.immunization;
+
+	vector<double> nu, fu;
+	vector<bool> ncached, fcached;
+	{
+		ProfileScope scope(BUY_CANDIDATES);
+
+		getBuyEdgeUtilities(i, ns, graph, nu, ncached);
+		getBuyEdgeUtilities(i, fs, graph, fu, fcached);
+
+		for (int k = 0; k < buys.size(); ++k) {
+			buyEdgeDeviation(i, buys[k], ns, graph, nu, ncached, bs, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+
+			buyEdgeDeviation(i, buys[k], fs, graph, fu, fcached, bs, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+		}
+	}
+
+	ProfileScope scope(SWAP_CANDIDATES);
+
+	for (it = drops.begin(); it != drops.end(); ++it) {
+		ns = s[i];
+		Graph ng = graph; //The graph corresponding to s
+
+		dropEdge(ns, ng, i, *it);
+
+		fs = ns;
+		fs.immunization = not fs.immunization;
+
+		getBuyEdgeUtilities(i, ns, ng, nu, ncached);
+		getBuyEdgeUtilities(i, fs, ng, fu, fcached);
+
+		for (int k = 0; k < buys.size(); ++k) {
+			buyEdgeDeviation(i, buys[k], ns, ng, nu, ncached, bs, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+
+			buyEdgeDeviation(i, buys[k], fs, ng, fu, fcached, bs, bg, bu);
+			if (bu > cu)
+				return make_pair(bs, bg);
+		}
+	}
+
+	return make_pair(bs, bg);
+}
+
+list<int> Model::getDropOrder(int i) {
+	vector<pair<int, int> > drops; //Minus the number of immunized neighbours, and the player
+	list<int>::iterator it;
+	for (it = s[i].bought.begin(); it != s[i].bought.end(); ++it) {
+		int immunized = 0;
+		const vector<int> &edgesj = graph.getEdges(*it);
+		for (int e = 0; e < edgesj.size(); ++e) {
+			if (edgesj[e] != i and s[edgesj[e]].immunization)
+				++immunized;
+		}
+		drops.push_back(make_pair(-immunized, playerOf[*it]));
+	}
+	sort(drops.begin(), drops.end());
+
+	list<int> order;
+	for (int k = 0; k < drops.size(); ++k)
+		order.push_back(nodeOf[drops[k].second]);
+	return order;
+}
+
+vector<int> Model::getBuyOrder(int i) {
+	Graph g = graph; //The graph without the targeted regions
+	list<VulnerableRegion> tr = getVulnerableRegionsMaxSize(i, s[i], graph);
+	list<VulnerableRegion>::iterator it;
+	for (it = tr.begin(); it != tr.end(); ++it)
+		g.deleteNodes(*it);
+
+	vector<int> labels, sizes;
+	getConnectedComponents(g, labels, sizes);
+
+	vector<bool> connected = getNeighbours(i); //The nodes i is connected to in s
+
+	vector<pair<pair<int, int>, int> > buys; //Minus the size of the safe component, not immunized, and the player
+	for (int j = 0; j < s.size(); ++j) {
+		if (not connected[j] and j != i) {
+			int size = 0;
+			if (labels[j] != -1 and labels[j] != labels[i])
+				size = sizes[labels[j]];
+			buys.push_back(make_pair(make_pair(-size, not s[j].immunization), playerOf[j]));
+		}
+	}
+	sort(buys.begin(), buys.end());
+
+	vector<int> order;
+	for (int k = 0; k < buys.size(); ++k)
+		order.push_back(nodeOf[buys[k].second]);
+	return order;
+}
+
+pair <strategy, Graph> Model::fullBR(int i, double &ub) {
+	//The swapstable best response is the initial best strategy found
+	pair<strategy, Graph> swBR = swapstableBR(i);
+	strategy bs = swBR.first;
+	Graph bg = swBR.second;
+	double bu = calculateUtility(i, bs, bg);
+
+	Graph h = graph; //The graph corresponding to s without the edges bought by i
+	list<int> bought = s[i].bought;
+	list<int>::iterator it;
+	for (it = bought.begin(); it != bought.end(); ++it)
+		h.dropEdge(i, *it);
+
+	vector<int> reps;
+	int nVulnerable;
+	getTargetClasses(i, h, reps, nVulnerable);
+
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() +
+		chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(timeBudget));
+	bool timeout = false;
+	ub = bu;
+
+	//First with i's current immunization status, and then with the other one
+	for (int y = 0; y < 2; ++y) {
+		bool yi = (s[i].immunization != (y == 1));
+		list<int> X;
+		branchAndBound(i, yi, reps, nVulnerable, 0, X, h, bs, bg, bu, ub, deadline, timeout);
+	}
+
+	ub = max(ub, bu);
+	return make_pair(bs, bg);
+}
+
+vector<bool> Model::getNeighbours(int i) {
+	vector<bool> connected(s.size(), false);
+	const vector<int> &ni = graph.getEdges(i);
+	for (int e = 0; e < ni.size(); ++e)
+		connected[ni[e]] = true;
+	return connected;
+}
+
+void Model::getTargetClasses(int i, Graph h, vector<int> &reps, int &nVulnerable) {
+	h.deleteNode(i); //The paths through i depend on i's strategy
+
+	Graph gv = h; //Only the vulnerable nodes
+	Graph gi = h; //Only the immunized nodes
+	for (int j = 0; j < s.size(); ++j) {
+		if (j != i) {
+			if (s[j].immunization)
+				gv.deleteNode(j);
+			else
+				gi.deleteNode(j);
+		}
+	}
+
+	vector<bool> bought(s.size(), false); //The nodes i has bought an edge to in s
+	list<int>::iterator it;
+	for (it = s[i].bought.begin(); it != s[i].bought.end(); ++it)
+		bought[*it] = true;
+
+	const vector<int> &ni = graph.getEdges(i);
+	vector<bool> adjacent(s.size(), false); //The nodes that have bought an edge to i
+	for (int e = 0; e < ni.size(); ++e) {
+		if (not bought[ni[e]])
+			adjacent[ni[e]] = true;
+	}
+
+	reps.clear();
+	nVulnerable = 0;
+
+	for (int v = 0; v < 2; ++v) {
+		vector<int> labels, sizes;
+		getConnectedComponents(v == 0 ? gv : gi, labels, sizes);
+
+		vector<int> rep(sizes.size(), -1);
+		vector<bool> skip(sizes.size(), false);
+		for (int k = 0; k < s.size(); ++k) {
+			int j = nodeOf[k]; //The representatives are chosen in the order of the players
+			int l = labels[j];
+			if (l != -1) {
+				if (rep[l] == -1 or (bought[j] and not bought[rep[l]]))
+					rep[l] = j;
+				if (adjacent[j])
+					skip[l] = true; //i is already connected to the class
+			}
+		}
+
+		vector<pair<int, int> > classes; //Minus the size of each class, and the player of its representative
+		for (int l = 0; l < sizes.size(); ++l) {
+			if (not skip[l])
+				classes.push_back(make_pair(-sizes[l], playerOf[rep[l]]));
+		}
+		sort(classes.begin(), classes.end());
+
+		for (int c = 0; c < classes.size(); ++c)
+			reps.push_back(nodeOf[classes[c].second]);
+		if (v == 0)
+			nVulnerable = reps.size();
+	}
+}
+
+void Model::branchAndBound(int i, bool yi, vector<int> &reps, int nVulnerable, int k, list<int> &X, Graph &h,
+                           strategy &bs, Graph &bg, double &bu, double &ub,
+                           chrono::steady_clock::time_point deadline, bool &timeout) {
+	strategy cs; //The strategy of i that buys the edges to X
+	cs.bought = X;
+	cs.immunization = yi;
+
+	double b = boundUtility(i, cs, reps, nVulnerable, k, h);
+	if (b <= bu)
+		return; //No strategy of the subtree is better than bs
+
+	if (k == reps.size()) {
+		//Every representative has been decided, so b is the utility of cs
+		Graph cg = h;
+		list<int>::iterator it;
+		for (it = X.begin(); it != X.end(); ++it)
+			cg.addEdge(i, *it);
+
+		bs = cs;
+		bg = cg;
+		bu = b;
+		return;
+	}
+
+	if (timeBudget > 0 and (timeout or chrono::steady_clock::now() > deadline)) {
+		timeout = true;
+		ub = max(ub, b); //The subtree is left unexplored
+		return;
+	}
+
+	X.push_back(reps[k]);
+	branchAndBound(i, yi, reps, nVulnerable, k + 1, X, h, bs, bg, bu, ub, deadline, timeout);
+	X.pop_back();
+
+	branchAndBound(i, yi, reps, nVulnerable, k + 1, X, h, bs, bg, bu, ub, deadline, timeout);
+}
+
+double Model::boundUtility(int i, strategy cs, vector<int> &reps, int nVulnerable, int k, Graph h) {
+	list<int>::iterator it;
+	for (it = cs.bought.begin(); it != cs.bought.end(); ++it)
+		h.addEdge(i, *it);
+
+	//We add the edges to all the undecided representatives, without paying for them
+	for (int j = k; j < reps.size(); ++j)
+		h.addEdge(i, reps[j]);
+
+	if (cs.immunization or k >= nVulnerable)
+		//The vulnerable regions do not depend on the undecided edges, which can only make i's connected
+		//component larger after any attack
+		return calculateUtility(i, cs, h);
+
+	else {
+		//The undecided edges may change the vulnerable regions, but i's connected component after any attack is
+		//contained in the one without attacks
+		list<int> xi = cs.bought;
+		bool yi = cs.immunization;
+		return getConnectedComponentSize(i, h) - (xi.size() * ce + yi * ci);
+	}
+}
+
 void Model::doDropEdgeDeviations(int i, strategy &bs, Graph &bg, double &bu) {
+	ProfileScope scope(DROP_CANDIDATES);
+
 	list<int> bought = s[i].bought;
 	list<int>::iterator it;
 	for (it = bought.begin(); it != bought.end(); ++it) {
@@ -139,45 +863,133 @@ void Model::doDropEdgeDeviations(int i, strategy &bs, Graph &bg, double &bu) {
 }
 
 void Model::doBuyEdgeDeviations(int i, strategy &bs, Graph &bg, double &bu) {
-	for (int j = 0; j < s.size(); j++) {
-		if (not graph.existsEdge(i, j)) {
-			//For each edge i has not bought
+	ProfileScope scope(BUY_CANDIDATES);
 
-			strategy cs = s[i]; //Current strategy of i, s_i
-			Graph cg = graph; //The graph corresponding to s
+	strategy ns = s[i]; //Current strategy of i, s_i
+	strategy fs = ns; //s_i with i's immunization status changed
+	fs.immunization = not fs.immunization;
 
-			buyEdge(cs, cg, i, j);
+	vector<double> nu, fu;
+	vector<bool> ncached, fcached;
+	getBuyEdgeUtilities(i, ns, graph, nu, ncached);
+	getBuyEdgeUtilities(i, fs, graph, fu, fcached);
 
-			updateBestStrategy(i, cs, bs, cg, bg, bu);
+	vector<bool> connected = getNeighbours(i); //The nodes i is connected to in s
 
-			changeImmunizationDeviation(i, cs, bs, cg, bg, bu);
+	//The candidates are tried in the order of the players, which breaks the ties between equal utilities. Each
+	//candidate only reads its entries of the cached utilities, unless it changes the vulnerable regions
+	for (int k = 0; k < s.size(); k++) {
+		int j = nodeOf[k];
+		if (not connected[j]) {
+			//For each edge i has not bought
+
+			buyEdgeDeviation(i, j, ns, graph, nu, ncached, bs, bg, bu);
+
+			buyEdgeDeviation(i, j, fs, graph, fu, fcached, bs, bg, bu);
 		}
 	}
 }
 
 void Model::doSwapEdgesDeviations(int i, strategy &bs, Graph &bg, double &bu) {
+	ProfileScope scope(SWAP_CANDIDATES);
+
+	vector<bool> connected = getNeighbours(i); //The nodes i is connected to in s
+
 	list<int> bought = s[i].bought;
 	list<int>::iterator it;
 	for (it = bought.begin(); it != bought.end(); ++it) {
 		//For each edge i has bought
 
-		for (int j = 0; j < s.size(); ++j) {
-			if (not graph.existsEdge(i, j)) {
-				//For each edge i has not bought
+		strategy ns = s[i]; //Current strategy of i, s_i
+		Graph ng = graph; //The graph corresponding to s
+
+		dropEdge(ns, ng, i, *it);
+
+		strategy fs = ns; //With i's immunization status changed
+		fs.immunization = not fs.immunization;
 
-				strategy cs = s[i]; //Current strategy of i, s_i
-				Graph cg = graph; //The graph corresponding to s
+		vector<double> nu, fu;
+		vector<bool> ncached, fcached;
+		getBuyEdgeUtilities(i, ns, ng, nu, ncached);
+		getBuyEdgeUtilities(i, fs, ng, fu, fcached);
 
-				swapEdges(cs, cg, i, *it, j);
+		for (int k = 0; k < s.size(); ++k) {
+			int j = nodeOf[k]; //The candidates are tried in the order of the players, as in doBuyEdgeDeviations
+			if (not connected[j]) {
+				//For each edge i has not bought
 
-				updateBestStrategy(i, cs, bs, cg, bg, bu);
+				buyEdgeDeviation(i, j, ns, ng, nu, ncached, bs, bg, bu);
 
-				changeImmunizationDeviation(i, cs, bs, cg, bg, bu);
+				buyEdgeDeviation(i, j, fs, ng, fu, fcached, bs, bg, bu);
 			}
 		}
 	}
 }
 
+void Model::getBuyEdgeUtilities(int i, strategy cs, Graph cg, vector<double> &u, vector<bool> &cached) {
+	u = vector<double>(s.size(), 0); //First the expected size of i's connected component, and then the utility
+	cached = vector<bool>(s.size(), true);
+
+	if (not cs.immunization) {
+		//Only the edges to vulnerable nodes of other vulnerable regions change the vulnerable regions
+		Graph gv = cg;
+		deleteImmunizedNodes(i, cs, gv);
+
+		vector<int> labels, sizes;
+		getConnectedComponents(gv, labels, sizes);
+
+		for (int j = 0; j < s.size(); ++j)
+			cached[j] = (labels[j] == -1 or labels[j] == labels[i]);
+	}
+
+	list<AttackScenario> sc = getAttackScenarios(i, cs, cg);
+
+	list<AttackScenario>::iterator it;
+	for (it = sc.begin(); it != sc.end(); ++it) {
+		//For each attack scenario
+
+		Graph aux = cg;
+		aux.deleteNodes(it->second); //Delete the attacked nodes
+
+		vector<int> labels, sizes;
+		getConnectedComponents(aux, labels, sizes);
+
+		int li = labels[i];
+		if (li == -1)
+			continue; //i has been deleted, so her connected component has size 0 whatever edge she buys
+
+		for (int j = 0; j < s.size(); ++j) {
+			int lj = labels[j];
+			int ccsz = sizes[li]; //The size of i's connected component after buying the edge (i, j)
+			if (lj != -1 and lj != li)
+				ccsz += sizes[lj];
+
+			u[j] += it->first * ccsz;
+		}
+	}
+
+	for (int j = 0; j < s.size(); ++j)
+		u[j] = u[j] - ((cs.bought.size() + 1) * ce + cs.immunization * ci);
+}
+
+void Model::buyEdgeDeviation(int i, int j, strategy cs, Graph &cg, vector<double> &u, vector<bool> &cached,
+                             strategy &bs, Graph &bg, double &bu) {
+	if (cached[j]) {
+		if (u[j] > bu) {
+			bs = cs;
+			bg = cg;
+			buyEdge(bs, bg, i, j);
+			bu = u[j];
+		}
+	}
+
+	else {
+		Graph ng = cg;
+		buyEdge(cs, ng, i, j);
+		updateBestStrategy(i, cs, bs, ng, bg, bu);
+	}
+}
+
 void Model::changeImmunizationDeviation(int i, strategy cs, strategy &bs, Graph cg, Graph &bg, double &bu)  {
 	cs.immunization = not cs.immunization;
 	updateBestStrategy(i, cs, bs, cg, bg, bu);
@@ -213,6 +1025,8 @@ void Model::updateBestStrategy(int i, strategy cs, strategy &bs, Graph cg, Graph
 }
 
 double Model::calculateUtility(int i, strategy si, Graph g) {
+	ProfileScope scope(UTILITY);
+
 	double expsz; //The expected size of i's connected component after the attack.
 	list<VulnerableRegion> vr = getVulnerableRegionsMaxSize(i, si, g);
 
@@ -230,6 +1044,92 @@ double Model::calculateUtility(int i, strategy si, Graph g) {
 	return expsz - (xi.size() * ce + yi * ci);
 }
 
+vector<double> Model::calculateUtilities() {
+	vector<double> u(s.size(), 0); //For each player, first her expected connected component size, and then her utility
+
+	if (s.size() == 0)
+		return u;
+
+	//The attack scenarios are the same for all the players, so we calculate them as those of player 0 in (s_{-0}, s_0)
+	list<AttackScenario> sc = getAttackScenarios(0, s[0], graph);
+
+	list<AttackScenario>::iterator it;
+	for (it = sc.begin(); it != sc.end(); ++it) {
+		//For each attack scenario
+
+		Graph aux = graph;
+		aux.deleteNodes(it->second); //Delete the attacked nodes
+
+		vector<int> labels, sizes;
+		getConnectedComponents(aux, labels, sizes);
+
+		for (int j = 0; j < s.size(); ++j) {
+			if (labels[j] != -1) //The deleted players have a connected component of size 0
+				u[j] += it->first * sizes[labels[j]];
+		}
+	}
+
+	for (int j = 0; j < s.size(); ++j) {
+		list<int> xj = s[j].bought;
+		bool yj = s[j].immunization;
+		u[j] = u[j] - (xj.size() * ce + yj * ci);
+	}
+	return u;
+}
+
+list<AttackScenario> Model::getAttackScenarios(int i, strategy si, Graph g) {
+	list<AttackScenario> sc;
+	list<VulnerableRegion> vr = getVulnerableRegionsMaxSize(i, si, g);
+
+	if (vr.size() == 0) //No vulnerable regions, so the adversary makes no attack
+		sc.push_back(make_pair(1.0, list<int>()));
+
+	else if (not adv2attacks) { //The adversary attacks one of the targeted regions
+		double probT = 1.0/vr.size();
+
+		list<VulnerableRegion>::iterator it;
+		for (it = vr.begin(); it != vr.end(); ++it)
+			sc.push_back(make_pair(probT, *it));
+	}
+
+	else if (vr.size() == 1) { //The adversary attacks the vulnerable region of maximum size t, and one of the next maximum size
+		VulnerableRegion t = *(vr.begin());
+
+		g.deleteNodes(t);
+		list<VulnerableRegion> vr2 = getVulnerableRegionsMaxSize(i, si, g);
+
+		if (vr2.size() == 0) //The adversary only attacks t
+			sc.push_back(make_pair(1.0, t));
+
+		else {
+			double probT = 1.0/vr2.size();
+
+			list<VulnerableRegion>::iterator it;
+			for (it = vr2.begin(); it != vr2.end(); ++it) {
+				list<int> attacked = t;
+				attacked.insert(attacked.end(), it->begin(), it->end());
+				sc.push_back(make_pair(probT, attacked));
+			}
+		}
+	}
+
+	else { //The adversary attacks two of the targeted regions
+		double probT = 2.0/(vr.size()*(vr.size()-1));
+
+		list<VulnerableRegion>::iterator it;
+		for (it = vr.begin(); it != vr.end(); ++it) {
+			list<VulnerableRegion>::iterator it2 = it;
+			++it2;
+			for (; it2 != vr.end(); ++it2) {
+				list<int> attacked = *it;
+				attacked.insert(attacked.end(), it2->begin(), it2->end());
+				sc.push_back(make_pair(probT, attacked));
+			}
+		}
+	}
+	return sc;
+}
+
 double Model::calculateExpectedSzCC1attack(int i, Graph g, list<VulnerableRegion> tr) {
 	double expSz = 0; //The expected size of i's connected component after the attack
 	double probT = 1.0/tr.size(); //The probability of attack to a targeted region
@@ -328,20 +1228,45 @@ list<VulnerableRegion> Model::getVulnerableRegionsMaxSize(int i, strategy si, Gr
 }
 
 list<VulnerableRegion> Model::getVulnerableRegions(int i, strategy si, Graph g) {
+	ProfileScope scope(VULNERABLE_REGIONS);
+
 	deleteImmunizedNodes(i, si, g);
 
-	list<VulnerableRegion> vr;
 	vector<bool> visited(s.size(), false);
 
-	//Puts in vr all the connected components of the graph g, where we have deleted the immunized nodes
+	//Puts in vr all the connected components of the graph g, where we have deleted the immunized nodes, in the
+	//order of the internal nodes, which is the order of the memory
+	list<VulnerableRegion> vr;
+	vector<pair<int, list<VulnerableRegion>::iterator> > firsts; //The first player of each region, and the region
+	bool sorted = true; //The regions are in the order of their first players
 	for (int j = 0; j < s.size(); ++j) {
 		if (not visited[j] and not g.isDeleted(j)) {
-			VulnerableRegion v;
-			getConnectedComponentUtil(j, visited, v, g);
-			vr.push_back(v);
+			vr.push_back(VulnerableRegion());
+			getConnectedComponentUtil(j, visited, vr.back(), g);
+
+			int first = s.size();
+			VulnerableRegion::iterator it;
+			for (it = vr.back().begin(); it != vr.back().end(); ++it)
+				first = min(first, playerOf[*it]);
+
+			sorted = sorted and (firsts.empty() or firsts.back().first < first);
+			firsts.push_back(make_pair(first, prev(vr.end())));
 		}
 	}
-	return vr;
+
+	if (sorted)
+		return vr;
+
+	//Moves them to the order of their first players, which does not depend on the internal nodes
+	sort(firsts.begin(), firsts.end(), [](const pair<int, list<VulnerableRegion>::iterator> &a,
+	                                      const pair<int, list<VulnerableRegion>::iterator> &b) {
+		return a.first < b.first;
+	});
+
+	list<VulnerableRegion> svr;
+	for (int r = 0; r < firsts.size(); ++r)
+		svr.splice(svr.end(), vr, firsts[r].second);
+	return svr;
 }
 
 void Model::deleteImmunizedNodes(int i, strategy si, Graph &g) {
@@ -358,6 +1283,8 @@ void Model::deleteImmunizedNodes(int i, strategy si, Graph &g) {
 }
 
 int Model::getConnectedComponentSize(int i, Graph g) {
+	ProfileScope scope(COMPONENT_SEARCH);
+
 	vector<bool> visited(s.size(), false);
 	list<int> CC;
 
@@ -367,14 +1294,33 @@ int Model::getConnectedComponentSize(int i, Graph g) {
 	return CC.size();
 }
 
-void Model::getConnectedComponentUtil(int i, vector<bool> &visited, list<int> &CC, Graph g) {
+void Model::getConnectedComponentUtil(int i, vector<bool> &visited, list<int> &CC, Graph &g) {
 	visited[i] = true;
 	CC.push_back(i);
 
-	list<int>::iterator it;
-	list<int> edgesi = g.getEdges(i);
-	for(it = edgesi.begin(); it != edgesi.end(); ++it) {
-		if (not visited[*it])
-			getConnectedComponentUtil(*it, visited, CC, g);
+	const vector<int> &edgesi = g.getEdges(i);
+	for (int e = 0; e < edgesi.size(); ++e) {
+		if (not visited[edgesi[e]])
+			getConnectedComponentUtil(edgesi[e], visited, CC, g);
+	}
+}
+
+void Model::getConnectedComponents(Graph &g, vector<int> &labels, vector<int> &sizes) {
+	ProfileScope scope(COMPONENT_SEARCH);
+
+	labels = vector<int>(s.size(), -1);
+	sizes.clear();
+	vector<bool> visited(s.size(), false);
+
+	for (int j = 0; j < s.size(); ++j) {
+		if (not visited[j] and not g.isDeleted(j)) {
+			list<int> CC;
+			getConnectedComponentUtil(j, visited, CC, g);
+
+			list<int>::iterator it;
+			for (it = CC.begin(); it != CC.end(); ++it)
+				labels[*it] = sizes.size();
+			sizes.push_back(CC.size());
+		}
 	}
 }
\ No newline at end of file
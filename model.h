@@ -2,36 +2,93 @@
 	Represents the Network Formation with attacks and immunization model.
 */
 
+#ifndef MODEL_H
+#define MODEL_H
+
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
 #include <fstream>
 #include <utility>
+#include <string>
 #include "graph.h"
 using namespace std;
 
 typedef list<int> VulnerableRegion;
 
+///An attack scenario: the probability that the adversary makes it and the list of nodes she deletes.
+typedef pair<double, list<int> > AttackScenario;
+
 struct strategy {
 	list<int> bought;
 	bool immunization;
 };
 
+///The orders of the internal nodes of the graph, to improve the locality of the traversals:
+enum Relabeling {
+	NO_RELABELING, ///The order of the players
+	BFS_ORDER, ///The order in which a breadth-first search visits the nodes
+	RCM_ORDER, ///The reverse Cuthill-McKee order
+	DEGREE_ORDER ///By decreasing degree
+};
+
+///A deviation of a player from the current strategy profile that improves her utility:
+struct deviation {
+	int player;
+	strategy improving; //The strategy the player deviates to
+	double gap; //The utility the player gains
+};
+
+///Statistics of a run of the dynamics:
+struct dynamicsStats {
+	int rounds; //The number of rounds
+	int moves; //The number of strategy changes
+	bool converged; //Whether the dynamics has reached an equilibrium
+	double seconds; //The running time
+};
+
+///The best responses the players compute in the dynamics:
+enum ResponseMode {
+	SWAPSTABLE, ///Dropping, buying or swapping a single edge, with or without changing the immunization status
+	FULL, ///Purchasing any subset of edges, with any immunization status
+	BETTER ///The first of the swapstable deviations that improves the utility, tried in a heuristic order
+};
+
 
 class Model {
 
 	private:
-		///The current strategy profile:
+		///The current strategy profile, indexed by the internal nodes, which are also the nodes of graph. The
+		///public methods take and return the players instead:
 		vector<strategy> s;
 
+		///For each internal node, its player:
+		vector<int> playerOf;
+
+		///For each player, her internal node:
+		vector<int> nodeOf;
+
 		///The corresponding graph to s:
 		Graph graph;
 
+		///The order of the internal nodes, and the number of rounds of the dynamics between two relabelings
+		///(0 to never relabel again):
+		Relabeling relabeling;
+		int relabelPeriod;
+
 		///Edge cost and immunization cost:
 		double ce, ci;
 
 		///The adversary (true for two attacks):
 		bool adv2attacks;
 
+		///The time budget, in seconds, of each full best response search (0 for no limit):
+		double timeBudget;
+
+		///The largest gap between the certified bound and the utility of the full best responses found in the
+		///last dynamics (0 if all of them are exact):
+		double fullBRGap;
+
 
 
 		/**
@@ -50,6 +107,37 @@ class Model {
 		void initEdges(int m);
 
 
+		/**
+			Makes each player her own internal node.
+		*/
+		void initNodes();
+
+
+		/**
+			Renumbers the internal nodes in the order of relabeling, if it is not NO_RELABELING, and rebuilds the
+			strategy profile s and the graph with the new numbers.
+		*/
+		void relabel();
+
+
+		/**
+			Returns the internal nodes in the order of relabeling.
+
+			@returns For each new internal node, the current one.
+		*/
+		vector<int> getRelabelingOrder();
+
+
+		/**
+			Returns a strategy whose edges are bought to players, from the same strategy with the edges bought
+			to internal nodes.
+
+			@param si A strategy with internal nodes.
+			@returns The strategy with players.
+		*/
+		strategy toPlayers(strategy si);
+
+
 		/**
 			Returns a swapstable best response s'_i for the player i to s_{-i}, as well as the corresponding graph
 			to the strategy profile (s_{-i}, s'_i). If the current strategy of s is already a swapstable best
@@ -61,6 +149,137 @@ class Model {
 		pair <strategy, Graph> swapstableBR(int i); 
 
 
+		/**
+			Returns a best response s'_i for the player i to s_{-i}, among all the strategies of i, as well as the
+			corresponding graph to the strategy profile (s_{-i}, s'_i). If the current strategy of s is already a
+			best response, returns the current strategy.
+
+			The targets of the edges are grouped into equivalence classes: the vulnerable regions and the
+			connected components of immunized nodes of the graph without i and the edges bought by i. Buying an
+			edge to any node of a class gives i the same utility, and buying two edges to the same class is never
+			better than buying one, so the search is a branch and bound over the subsets of classes. If the time
+			budget runs out, returns the best strategy found.
+
+			@param[in] i A player.
+			@param[out] ub A certified upper bound of the utility of i's best responses. It is the utility of
+			               the returned strategy if the search has finished within the time budget.
+			@returns A best response s'_i and the corresponding graph to (s_{-i}, s'_i).
+		*/
+		pair <strategy, Graph> fullBR(int i, double &ub);
+
+
+		/**
+			Returns the nodes connected to i in the graph corresponding to s, so that the loops over the
+			candidates do not search the edges of each of them.
+
+			@param i A node.
+			@returns For each node j, true if exists (i,j).
+		*/
+		vector<bool> getNeighbours(int i);
+
+
+		/**
+			Returns the first swapstable deviation s'_i of the player i from s_i that improves her utility, as well
+			as the corresponding graph to the strategy profile (s_{-i}, s'_i). If there is none, returns the current
+			strategy. The deviations are tried in the order of getDropOrder and getBuyOrder: first changing i's
+			immunization status, then the drops, then the purchases and last the swaps, each of them both without
+			and with changing i's immunization status.
+
+			@param i A player.
+			@returns An improving swapstable deviation s'_i and the corresponding graph to (s_{-i}, s'_i).
+		*/
+		pair <strategy, Graph> betterResponse(int i);
+
+
+		/**
+			Returns the nodes i has bought an edge to in s, in the order to try dropping them in betterResponse:
+			those with more immunized neighbours first, as they are likely to stay connected to i through them.
+
+			@param i A player.
+			@returns The nodes i has bought an edge to.
+		*/
+		list<int> getDropOrder(int i);
+
+
+		/**
+			Returns the nodes i can buy an edge to in s, in the order to try buying them in betterResponse: by
+			decreasing size of their connected component in the graph without the targeted regions, and the
+			immunized nodes first. The nodes in i's component are left for the end.
+
+			@param i A player.
+			@returns The nodes j such that the edge (i, j) does not exist.
+		*/
+		vector<int> getBuyOrder(int i);
+
+
+		/**
+			Returns the response of the player i to s_{-i} of the given mode, and the corresponding graph.
+
+			@param[in] i A player.
+			@param[in] mode The response to compute.
+			@param[out] gap The gap between the certified bound and the utility of the response, if it is a full
+			                best response that has run out of time, or 0 otherwise.
+			@returns The response s'_i and the corresponding graph to (s_{-i}, s'_i).
+		*/
+		pair <strategy, Graph> response(int i, ResponseMode mode, double &gap);
+
+
+		/**
+			Returns a representative node of each equivalence class of targets of the edges that i can buy.
+			The classes with a node that has already bought an edge to i are not considered.
+
+			@param[in] i A player.
+			@param[in] h The graph corresponding to s without the edges bought by i.
+			@param[out] reps The representatives, first those of the vulnerable classes and then those of the
+			                 immunized ones, each group by decreasing size of the class. The representative is
+			                 a node i has bought an edge to in s, if there is one in the class.
+			@param[out] nVulnerable The number of vulnerable classes.
+		*/
+		void getTargetClasses(int i, Graph h, vector<int> &reps, int &nVulnerable);
+
+
+		/**
+			Explores the strategies of i with immunization status yi that buy the edges to the representatives
+			of X, and decide, for each representative from the k-th on, whether to buy an edge to it. If a
+			strategy s'_i such that i has a better utility in (s_{-i}, s'_i) than bu is found, updates the best
+			strategy bs, the corresponding utility bu and the graph corresponding to (s_{-i}, bs).
+
+			@param[in] i A player.
+			@param[in] yi The immunization status of i.
+			@param[in] reps The representatives of the classes of targets.
+			@param[in] nVulnerable The number of vulnerable classes.
+			@param[in] k The first representative not decided yet.
+			@param[in, out] X The representatives i buys an edge to. Restored on return.
+			@param[in] h The graph corresponding to s without the edges bought by i.
+			@param[out] bs The best strategy found, if it is better than bu.
+			@param[out] bg The graph corresponding to (s_{-i}, bs), if a better strategy than bu is found.
+			@param[in, out] bu In: the utility we compare to the utilities found.
+			                   Out: the utility of i in the strategy profile (s_{-i}, bs).
+			@param[in, out] ub The largest bound of the subtrees left unexplored when the time budget runs out.
+			@param[in] deadline The time when the time budget runs out.
+			@param[in, out] timeout Whether the time budget has run out.
+		*/
+		void branchAndBound(int i, bool yi, vector<int> &reps, int nVulnerable, int k, list<int> &X, Graph &h,
+		                    strategy &bs, Graph &bg, double &bu, double &ub,
+		                    chrono::steady_clock::time_point deadline, bool &timeout);
+
+
+		/**
+			Returns an upper bound of the utility of i in all the strategy profiles (s_{-i}, s'_i) such that s'_i
+			buys the edges of cs, buys any subset of edges to the representatives from the k-th on, and has the
+			immunization status of cs. If every representative has been decided, returns the exact utility.
+
+			@param i A player.
+			@param cs A strategy of i.
+			@param reps The representatives of the classes of targets.
+			@param nVulnerable The number of vulnerable classes.
+			@param k The first representative not decided yet.
+			@param h The graph corresponding to s without the edges bought by i.
+			@returns The upper bound.
+		*/
+		double boundUtility(int i, strategy cs, vector<int> &reps, int nVulnerable, int k, Graph h);
+
+
 		/**
 			Tries all the deviations from s consisting of i dropping an edge, both with and without changing
 			i's immunization status. If a strategy s'_i such that i has a better utility in (s_{-i}, s'_i) than bu
@@ -115,6 +334,44 @@ class Model {
 		void doSwapEdgesDeviations(int i, strategy &bs, Graph &bg, double &bu);
 
 
+		/**
+			Calculates, for each node j, the utility of i in the strategy profile (s_{-i}, cs) after i buys the
+			edge (i, j), whenever it does not change the vulnerable regions. Then the attack scenarios are those
+			of (s_{-i}, cs), so the connected components after each attack are calculated once for all the nodes j,
+			and i's connected component is the union of the components of i and j.
+
+			@param[in] i A player.
+			@param[in] cs A strategy of i.
+			@param[in] cg The graph corresponding to (s_{-i}, cs).
+			@param[out] u For each node j such that cached[j], the utility of i after buying the edge (i, j).
+			@param[out] cached For each node j, whether buying the edge (i, j) does not change the vulnerable
+			                   regions, that is, i or j are immunized, or they are in the same vulnerable region.
+		*/
+		void getBuyEdgeUtilities(int i, strategy cs, Graph cg, vector<double> &u, vector<bool> &cached);
+
+
+		/**
+			Tries the deviation from (s_{-i}, cs) consisting of i buying the edge (i, j). If i has a better
+			utility in the new strategy profile (s_{-i}, s'_i) than bu, updates the best strategy bs, the
+			corresponding utility bu and the graph corresponding to (s_{-i}, bs). The utility is read from u if
+			cached[j], and calculated otherwise.
+
+			@param[in] i A player.
+			@param[in] j The node i buys an edge to.
+			@param[in] cs A strategy of i.
+			@param[in] cg The graph corresponding to (s_{-i}, cs).
+			@param[in] u The utilities calculated by getBuyEdgeUtilities for cs.
+			@param[in] cached The utilities of u that are valid.
+			@param[out] bs The strategy s'_i, if i has a better utility in (s_{-i}, s'_i) than bu.
+			@param[out] bg The graph corresponding to (s_{-i}, bs), if i has a better utility in (s_{-i}, s'_i)
+			               than bu.
+			@param[in, out] bu In: the utility we compare to the utility of s'_i.
+			                   Out: the utility of i in the strategy profile (s_{-i}, bs).
+		*/
+		void buyEdgeDeviation(int i, int j, strategy cs, Graph &cg, vector<double> &u, vector<bool> &cached,
+		                      strategy &bs, Graph &bg, double &bu);
+
+
 		/**
 			Tries the deviation from (s_{-i}, cs) consisting of i changing her immunization status. If i has a
 			better utility in the new strategy profile (s_{-i}, s'_i) than bu, updates the best strategy bs, the
@@ -200,6 +457,28 @@ class Model {
 		double calculateUtility(int i, strategy si, Graph g);
 
 
+		/**
+			Returns the utility of every player in the current strategy profile s. The attack scenarios and the
+			connected components after each attack are calculated only once, and shared by all the players.
+
+			@returns For each internal node i, the utility of its player playerOf[i] in s.
+		*/
+		vector<double> calculateUtilities();
+
+
+		/**
+			Returns the attack scenarios of the strategy profile (s_{-i}, si), in the same order in which
+			calculateUtility adds up their contributions to the expected size of the connected components.
+
+			@param i A player.
+			@param si A strategy of player i.
+			@param g The graph corresponding to the strategy profile (s_{-i}, si).
+			@returns The list of attack scenarios. If there are no vulnerable regions, it only has a scenario,
+					 with probability 1, where no node is deleted.
+		*/
+		list<AttackScenario> getAttackScenarios(int i, strategy si, Graph g);
+
+
 		/**
 			Returns the expected size of the connected component of i in the graph g, with the list of targeted
 			regions tr, after the adversary makes a single attack.
@@ -313,7 +592,17 @@ class Model {
 							   Out: the whole connected component of i.
 			@param[in] g The graph.
 		*/
-		void getConnectedComponentUtil(int i, vector<bool> &visited, list<int> &CC, Graph g);
+		void getConnectedComponentUtil(int i, vector<bool> &visited, list<int> &CC, Graph &g);
+
+
+		/**
+			Labels the connected components of the graph g.
+
+			@param[in] g The graph.
+			@param[out] labels For each node j, the label of j's connected component, or -1 if j has been deleted.
+			@param[out] sizes For each label, the size of the corresponding connected component.
+		*/
+		void getConnectedComponents(Graph &g, vector<int> &labels, vector<int> &sizes);
 
 
 
@@ -329,6 +618,39 @@ class Model {
 		Model(int n, int m, double p);
 
 
+		/**
+			Reads a strategy profile stored in a csv file with the format of exportGraph, checking that the
+			file is well formed: a positive number of players n, followed by a row for each player with her
+			id, her immunization status and the ids of the players she buys edges to, ended with -1. All the
+			ids must be between 0 and n-1, and players cannot buy edges to themselves.
+
+			@param nameFile The name of the file.
+			@param s The strategy profile read.
+			@param error If the file is not well formed, the description of the first error found.
+			@returns True if the file can be read and is well formed.
+		*/
+		static bool readStrategyProfile(string nameFile, vector<strategy> &s, string &error);
+
+
+		/**
+			Creates the strategy profile s and its corresponding graph.
+
+			@param s The strategy profile.
+		*/
+		Model(vector<strategy> s);
+
+
+		/**
+			Sets the order of the internal nodes of the graph, and relabels them now. The players keep their
+			numbers in the public methods and the exported files, and the results do not depend on the order.
+
+			@param relabeling The order.
+			@param period The number of rounds of the dynamics between two relabelings, to follow the changes
+			              of the graph (0 to never relabel again).
+		*/
+		void setRelabeling(Relabeling relabeling, int period);
+
+
 		/**
 			Exports the graph corresponding to the current strategy profile s as a csv file.
 			First row is the number of nodes. Then, for each row, first column is the node i, second column i's immunization
@@ -340,11 +662,126 @@ class Model {
 
 
 		/**
-			Runs a swapstable best response dynamics, starting from the current strategy profile s.
+			Runs a best response dynamics, starting from the current strategy profile s.
 			
 			@param ce The cost of the edges.
 			@param ci The immunization cost.
 			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@param mode The responses the players compute: swapstable, full or better responses.
+			@param timeBudget The time budget, in seconds, of each full best response (0 for no limit).
+			@returns The statistics of the run. A round is a pass over all the players.
+		*/
+		dynamicsStats dynamics(double ce, double ci, bool adv2attacks, ResponseMode mode = SWAPSTABLE, double timeBudget = 0);
+
+
+		/**
+			Returns the largest gap between the certified bound and the utility of the full best responses
+			found in the last dynamics.
+
+			@returns The gap, or 0 if all the full best responses were exact.
+		*/
+		double getFullBRGap();
+
+
+		/**
+			Returns a best response s'_i for the player i to the current strategy profile s_{-i}. If the current
+			strategy of s is already a best response, returns the current strategy.
+
+			@param i A player.
+			@param ce The cost of the edges.
+			@param ci The immunization cost.
+			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@param mode The response to compute: swapstable, full or better response.
+			@param timeBudget The time budget, in seconds, of the full best response (0 for no limit).
+			@returns A best response s'_i.
+		*/
+		strategy bestResponse(int i, double ce, double ci, bool adv2attacks, ResponseMode mode, double timeBudget = 0);
+
+
+		/**
+			Runs a simultaneous-move best response dynamics, starting from the current strategy profile s. In
+			each round, all the players compute their best responses in parallel to the same strategy profile.
+			Then, to avoid oscillations, each player with an improving best response adopts it with probability
+			lambda (or a random one of them, if none does), in increasing order of the players. An edge bought by
+			two players in the same round is only kept by the first one.
+
+			@param ce The cost of the edges.
+			@param ci The immunization cost.
+			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@param lambda The probability that a player with an improving best response adopts it.
+			@param seed The seed of the random choices, which are the same whatever the number of threads.
+			@param maxRounds The maximum number of rounds.
+			@param nThreads The number of threads.
+			@param mode The responses the players compute: swapstable, full or better responses.
+			@param timeBudget The time budget, in seconds, of each full best response (0 for no limit).
+			@returns The statistics of the run. The last round, where no player improves, is also counted.
+		*/
+		dynamicsStats simultaneousDynamics(double ce, double ci, bool adv2attacks, double lambda, unsigned int seed,
+		                                   int maxRounds, int nThreads, ResponseMode mode = SWAPSTABLE,
+		                                   double timeBudget = 0);
+
+
+		/**
+			Checks whether the current strategy profile s is a swapstable equilibrium, computing the swapstable
+			best responses of the players in parallel.
+
+			@param ce The cost of the edges.
+			@param ci The immunization cost.
+			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@param nThreads The number of threads.
+			@param stopAtFirst If true, stops as soon as a player with an improving deviation is found.
+			@returns For each player whose swapstable best response improves her utility, sorted by player, the
+					 best response and the utility gained. Empty if s is a swapstable equilibrium. If stopAtFirst,
+					 it has at most a few deviations, those found before the threads stopped.
 		*/
-		void dynamics(double ce, double ci, bool adv2attacks);
-};
\ No newline at end of file
+		list<deviation> verifyEquilibrium(double ce, double ci, bool adv2attacks, int nThreads, bool stopAtFirst);
+
+
+		/**
+			Returns the current strategy profile s.
+
+			@returns The strategy profile s.
+		*/
+		vector<strategy> getStrategyProfile();
+
+
+		/**
+			Returns the graph corresponding to the current strategy profile s.
+
+			@returns The graph corresponding to s.
+		*/
+		Graph getGraph();
+
+
+		/**
+			Returns the list of vulnerable regions of the current strategy profile s.
+
+			@returns The list of vulnerable regions.
+		*/
+		list<VulnerableRegion> getVulnerableRegions();
+
+
+		/**
+			Returns the utility of every player in the current strategy profile s.
+
+			@param ce The cost of the edges.
+			@param ci The immunization cost.
+			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@returns For each player i, the utility of i in s.
+		*/
+		vector<double> calculateUtilities(double ce, double ci, bool adv2attacks);
+
+
+		/**
+			Returns the social welfare of the current strategy profile s, that is, the sum of the utilities of
+			all the players.
+
+			@param ce The cost of the edges.
+			@param ci The immunization cost.
+			@param adv2attacks The adversary (true for the one that makes 2 attacks)
+			@returns The social welfare of s.
+		*/
+		double calculateSocialWelfare(double ce, double ci, bool adv2attacks);
+};
+
+#endif
\ No newline at end of file
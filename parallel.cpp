@@ -0,0 +1,36 @@
+#include <thread>
+#include <vector>
+#include "parallel.h"
+
+
+int defaultNumThreads() {
+	int nThreads = thread::hardware_concurrency();
+	return (nThreads > 0) ? nThreads : 1;
+}
+
+void parallelFor(int n, int nThreads, const function<void(int)> &f, atomic<bool> &stop) {
+	atomic<int> next(0); //The next call not started yet
+
+	auto worker = [&]() {
+		int j;
+		while (not stop and (j = next++) < n)
+			f(j);
+	};
+
+	if (nThreads <= 1) {
+		worker();
+		return;
+	}
+
+	vector<thread> threads;
+	for (int t = 0; t < nThreads; ++t)
+		threads.push_back(thread(worker));
+
+	for (int t = 0; t < nThreads; ++t)
+		threads[t].join();
+}
+
+void parallelFor(int n, int nThreads, const function<void(int)> &f) {
+	atomic<bool> stop(false);
+	parallelFor(n, nThreads, f, stop);
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+/**
+	Helpers to run independent computations in parallel.
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <functional>
+using namespace std;
+
+
+/**
+	Returns the number of threads to use by default, which is the number of hardware threads, or 1 if it is
+	unknown.
+
+	@returns The number of threads.
+*/
+int defaultNumThreads();
+
+
+/**
+	Calls f(j) for every j from 0 to n-1, distributing the calls among nThreads threads. Each thread takes the
+	next j not started yet, so the calls can finish in any order.
+
+	@param n The number of calls.
+	@param nThreads The number of threads.
+	@param f The function to call. The calls with different j must be able to run at the same time.
+	@param stop When it becomes true, the calls not started yet are skipped.
+*/
+void parallelFor(int n, int nThreads, const function<void(int)> &f, atomic<bool> &stop);
+
+
+/**
+	Calls f(j) for every j from 0 to n-1, distributing the calls among nThreads threads.
+
+	@param n The number of calls.
+	@param nThreads The number of threads.
+	@param f The function to call. The calls with different j must be able to run at the same time.
+*/
+void parallelFor(int n, int nThreads, const function<void(int)> &f);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "profiler.h"
+
+bool profiling = false;
+
+///The measures of a kernel in a round:
+struct kernelStats {
+	long long calls;
+	long long timedCalls; //The calls measured with the clock
+	long long countedCalls; //The calls measured with the hardware counters
+	double seconds;
+	long long counts[N_COUNTERS];
+};
+
+///The run, the round and the kernel of some measures. The run and the round are -1 for all of them:
+typedef pair<pair<int, int>, int> ProfileKey;
+
+///The measures by run, round and kernel:
+typedef map<ProfileKey, kernelStats> Profile;
+
+///The run and the round the measures are aggregated to:
+static atomic<int> profiledRun(0);
+static atomic<int> profiledRound(0);
+
+///The label of each run:
+static vector<string> runLabels(1, "none");
+
+///The measures of the threads that have finished, or have been flushed:
+static Profile totalProfile;
+static mutex totalMutex;
+
+static const char *kernelNames[N_KERNELS] = {"graph_copy", "vulnerable_regions", "component_search", "utility",
+                                             "drop_candidates", "buy_candidates", "swap_candidates"};
+static const unsigned long long counterConfigs[N_COUNTERS] = {PERF_COUNT_HW_CPU_CYCLES,
+                                                              PERF_COUNT_HW_INSTRUCTIONS,
+                                                              PERF_COUNT_HW_CACHE_MISSES,
+                                                              PERF_COUNT_HW_BRANCH_MISSES};
+
+
+/**
+	Adds the measures of a kernel in a round of a run to some measures.
+
+	@param p The measures.
+	@param key The run, the round and the kernel.
+	@param ks The measures to add.
+*/
+static void addStats(Profile &p, ProfileKey key, kernelStats &ks) {
+	Profile::iterator it = p.find(key);
+	if (it == p.end()) {
+		p[key] = ks;
+		return;
+	}
+
+	it->second.calls += ks.calls;
+	it->second.timedCalls += ks.timedCalls;
+	it->second.countedCalls += ks.countedCalls;
+	it->second.seconds += ks.seconds;
+	for (int c = 0; c < N_COUNTERS; ++c)
+		it->second.counts[c] += ks.counts[c];
+}
+
+///The hardware counters and the measures of a thread, which are added to the total ones when it finishes:
+struct threadProfiler {
+	int fd[N_COUNTERS]; //The counters, in a group led by the first one, or -1 if they are not available
+	Profile profile;
+
+	///The measures the calls of each kernel were last counted in, to avoid searching them in profile for
+	///each call, and their run and round:
+	kernelStats *last[N_KERNELS];
+	int lastRun[N_KERNELS], lastRound[N_KERNELS];
+
+	threadProfiler() {
+		for (int k = 0; k < N_KERNELS; ++k)
+			last[k] = NULL;
+
+		for (int c = 0; c < N_COUNTERS; ++c) {
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = counterConfigs[c];
+			attr.read_format = PERF_FORMAT_GROUP;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+
+			//The calling thread, on any cpu
+			fd[c] = syscall(__NR_perf_event_open, &attr, 0, -1, (c == 0) ? -1 : fd[0], 0);
+			if (fd[c] == -1) {
+				//Either all the counters, or none of them
+				for (int d = 0; d < c; ++d)
+					close(fd[d]);
+				for (int d = 0; d < N_COUNTERS; ++d)
+					fd[d] = -1;
+				return;
+			}
+		}
+	}
+
+	~threadProfiler() {
+		flush();
+		for (int c = 0; c < N_COUNTERS and fd[c] != -1; ++c)
+			close(fd[c]);
+	}
+
+	/**
+		Reads the counters.
+
+		@param counts The counters.
+		@returns True if they are available.
+	*/
+	bool read(long long counts[]) {
+		if (fd[0] == -1)
+			return false;
+
+		unsigned long long values[1 + N_COUNTERS]; //The number of counters, and their values
+		if (::read(fd[0], values, sizeof(values)) != sizeof(values))
+			return false;
+
+		for (int c = 0; c < N_COUNTERS; ++c)
+			counts[c] = values[1 + c];
+		return true;
+	}
+
+	/**
+		Adds the measures of the thread to the total ones.
+	*/
+	void flush() {
+		lock_guard<mutex> lock(totalMutex);
+		Profile::iterator it;
+		for (it = profile.begin(); it != profile.end(); ++it)
+			addStats(totalProfile, it->first, it->second);
+		profile.clear();
+
+		for (int k = 0; k < N_KERNELS; ++k)
+			last[k] = NULL;
+	}
+
+	/**
+		Returns the measures of a kernel in a round of a run, which are created if needed.
+
+		@param run, round The run and the round.
+		@param kernel The kernel.
+		@returns The measures.
+	*/
+	kernelStats &getStats(int run, int round, Kernel kernel) {
+		if (last[kernel] == NULL or lastRun[kernel] != run or lastRound[kernel] != round) {
+			ProfileKey key = make_pair(make_pair(run, round), (int) kernel);
+			Profile::iterator it = profile.find(key);
+			if (it == profile.end()) {
+				kernelStats ks;
+				memset(&ks, 0, sizeof(ks));
+				it = profile.insert(make_pair(key, ks)).first;
+			}
+
+			last[kernel] = &it->second;
+			lastRun[kernel] = run;
+			lastRound[kernel] = round;
+		}
+		return *last[kernel];
+	}
+};
+
+static thread_local threadProfiler threadProfile;
+
+
+void startProfiling() {
+	profiling = true;
+}
+
+void countCall(Kernel kernel) {
+	++threadProfile.getStats(profiledRun, profiledRound, kernel).calls;
+}
+
+void startProfiledRun(string label) {
+	lock_guard<mutex> lock(totalMutex);
+	runLabels.push_back(label);
+	profiledRun = runLabels.size() - 1;
+	profiledRound = 0;
+}
+
+void setProfiledRound(int round) {
+	profiledRound = round;
+}
+
+bool writeProfile(string nameFile) {
+	threadProfile.flush();
+
+	lock_guard<mutex> lock(totalMutex);
+
+	//The measures in all the rounds of each run, and in all the runs
+	Profile all;
+	Profile::iterator it;
+	for (it = totalProfile.begin(); it != totalProfile.end(); ++it) {
+		int run = it->first.first.first;
+		int kernel = it->first.second;
+		addStats(all, make_pair(make_pair(run, -1), kernel), it->second);
+		addStats(all, make_pair(make_pair(-1, -1), kernel), it->second);
+	}
+
+	bool counted = false;
+	for (it = all.begin(); it != all.end(); ++it)
+		counted = counted or it->second.countedCalls > 0;
+
+	ofstream myfile;
+	myfile.open(nameFile);
+	myfile << "run,label,round,kernel,calls,seconds,cycles,instructions,llc_misses,branch_misses" << endl;
+
+	Profile *profiles[2] = {&totalProfile, &all};
+	for (int q = 0; q < 2; ++q) {
+		for (it = profiles[q]->begin(); it != profiles[q]->end(); ++it) {
+			int run = it->first.first.first;
+			int round = it->first.first.second;
+			if (run == -1)
+				myfile << "all,all";
+			else
+				myfile << run << "," << runLabels[run];
+
+			//The measures outside the rounds of a run are those of its round 0
+			if (round == -1)
+				myfile << ",all";
+			else if (round == 0)
+				myfile << ",none";
+			else
+				myfile << "," << round;
+
+			myfile << "," << kernelNames[it->first.second] << "," << it->second.calls << ",";
+			if (it->second.timedCalls > 0)
+				myfile << it->second.seconds;
+
+			for (int c = 0; c < N_COUNTERS; ++c) {
+				myfile << ",";
+				if (it->second.countedCalls > 0)
+					myfile << it->second.counts[c];
+			}
+			myfile << endl;
+		}
+	}
+	myfile.close();
+
+	return counted;
+}
+
+
+void ProfileScope::begin() {
+	run = profiledRun;
+	round = profiledRound;
+	counted = threadProfile.read(start);
+	startTime = chrono::steady_clock::now();
+}
+
+void ProfileScope::end() {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+	long long counts[N_COUNTERS];
+	bool countedEnd = counted and threadProfile.read(counts);
+
+	kernelStats &ks = threadProfile.getStats(run, round, kernel);
+	++ks.calls;
+	++ks.timedCalls;
+	ks.seconds += seconds;
+	if (countedEnd) {
+		++ks.countedCalls;
+		for (int c = 0; c < N_COUNTERS; ++c)
+			ks.counts[c] += counts[c] - start[c];
+	}
+}
@@ -0,0 +1,137 @@
+/**
+	Opt-in profiling of the hot kernels of the model with the hardware performance counters of each thread
+	(cycles, instructions, last-level cache misses and branch misses), aggregated by kernel, by run of the
+	dynamics and by round of each run. When the counters are not available, only the wall-clock time is
+	measured.
+
+	Measuring a kernel costs two reads of the clock and, with the counters, two read system calls on the
+	counter group, in the order of a microsecond. That cost is included in the measures of the kernels that
+	call it. The graph copies, which are too short and too many to be measured that way, are only counted.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <string>
+using namespace std;
+
+///The profiled kernels. The measures of a kernel include those of the kernels it calls:
+enum Kernel {
+	GRAPH_COPY, ///The copies of the graph, only counted
+	VULNERABLE_REGIONS, ///The search of the vulnerable regions
+	COMPONENT_SEARCH, ///The searches of the connected components in each attack scenario
+	UTILITY, ///The calculation of the utility of a player
+	DROP_CANDIDATES, ///The loop over the edges a player can drop
+	BUY_CANDIDATES, ///The loop over the edges a player can buy
+	SWAP_CANDIDATES, ///The loop over the edges a player can swap
+	N_KERNELS
+};
+
+///The hardware counters:
+enum Counter {
+	CYCLES,
+	INSTRUCTIONS,
+	LLC_MISSES,
+	BRANCH_MISSES,
+	N_COUNTERS
+};
+
+///True while the kernels are profiled. Only set it with startProfiling:
+extern bool profiling;
+
+
+/**
+	Starts profiling the kernels in all the threads.
+*/
+void startProfiling();
+
+
+/**
+	Starts a new run of the dynamics, which the next measures are aggregated to, outside its rounds. The
+	measures before the first run are aggregated to the run 0.
+
+	@param label The description of the run in the exported file.
+*/
+void startProfiledRun(string label);
+
+
+/**
+	Sets the round of the current run the next measures are aggregated to.
+
+	@param round The round, or 0 outside the rounds.
+*/
+void setProfiledRound(int round);
+
+
+/**
+	Counts a call of a kernel, without measuring it.
+
+	@param kernel The kernel.
+*/
+void countCall(Kernel kernel);
+
+
+/**
+	Counts a call of a kernel, without measuring it, if the kernels are profiled.
+
+	@param kernel The kernel.
+*/
+inline void countProfiledCall(Kernel kernel) {
+	if (profiling)
+		countCall(kernel);
+}
+
+
+/**
+	Exports the measures of each kernel in each round of each run, in all the rounds of each run, and in all
+	the runs, as a csv file. The counters are left empty when they were not available, and the time too for
+	the kernels that are only counted.
+
+	@param nameFile The name of the file.
+	@returns True if the hardware counters were available.
+*/
+bool writeProfile(string nameFile);
+
+
+/**
+	Measures a kernel from its creation to its destruction, if the kernels are profiled.
+*/
+class ProfileScope {
+
+	private:
+		Kernel kernel;
+		bool active;
+		int run, round;
+		long long start[N_COUNTERS]; //The counters at the start
+		bool counted; //The counters were read at the start
+		chrono::steady_clock::time_point startTime;
+
+		/**
+			Reads the counters and the time at the start.
+		*/
+		void begin();
+
+		/**
+			Reads them at the end, and adds the differences to the measures of the kernel in the round.
+		*/
+		void end();
+
+	public:
+		/**
+			Starts measuring a kernel.
+
+			@param kernel The kernel.
+		*/
+		ProfileScope(Kernel kernel) : kernel(kernel), active(profiling) {
+			if (active)
+				begin();
+		}
+
+		~ProfileScope() {
+			if (active)
+				end();
+		}
+};
+
+#endif